@@ -0,0 +1,220 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  concurrent_inplace_vector.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  Lock-free multi-producer append-only vector
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <span>
+#include "inplace_vector.h"
+
+#pragma warning(push)
+#pragma warning(disable: 26495) // "data_ is uninitialized", by design
+#pragma warning(disable: 4324)  // "structure was padded due to alignment specifier", by design
+
+namespace PKIsensee
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Append-only vector of at most Capacity elements that any number of threads may
+// fill concurrently. A producer reserves a slot with one fetch_add, constructs its
+// element there, and sets the slot's ready flag with release semantics. Readers
+// see the published prefix: the leading run of ready slots. Readers cache the
+// prefix length they find, so later reads scan only newly published slots.
+// Nothing blocks and nothing allocates.
+//
+// try_emplace_back() returns nullptr once Capacity slots have been reserved;
+// emplace_back() throws std::bad_alloc. If an element's constructor throws, its
+// slot is never published and the published prefix stops there.
+//
+// clear() and destruction must not race with producers or readers.
+
+template < typename T, size_t Capacity >
+class concurrent_inplace_vector
+{
+public:
+
+  using value_type      = T;
+  using size_type       = size_t;
+  using reference       = T&;
+  using const_reference = const T&;
+
+  // Constructors -------------------------------------------------------------
+
+  concurrent_inplace_vector() = default;
+
+  concurrent_inplace_vector( const concurrent_inplace_vector& ) = delete;
+  concurrent_inplace_vector& operator=( const concurrent_inplace_vector& ) = delete;
+
+  ~concurrent_inplace_vector()
+  {
+    destroyAll();
+  }
+
+  // Producers ----------------------------------------------------------------
+
+  // Constructs an element in a newly reserved slot, or returns nullptr if full
+  template <typename... Types>
+  T* try_emplace_back( Types&&... values )
+  {
+    // Once full, reserved_ keeps counting past Capacity; the first check keeps a
+    // spinning producer from doing so indefinitely
+    if ( reserved_.load( std::memory_order_relaxed ) >= Capacity )
+      return nullptr;
+    const auto i = reserved_.fetch_add( 1, std::memory_order_relaxed );
+    if ( i >= Capacity )
+      return nullptr;
+    const auto p = std::construct_at( ptr( i ), std::forward<Types>( values )... );
+    ready_[ i ].store( true, std::memory_order_release );
+    return p;
+  }
+
+  template <typename... Types>
+  T& emplace_back( Types&&... values )
+  {
+    const auto p = try_emplace_back( std::forward<Types>( values )... );
+    if ( p == nullptr )
+      throw std::bad_alloc();
+    return *p;
+  }
+
+  T* try_push_back( const T& value )
+  {
+    return try_emplace_back( value );
+  }
+
+  T* try_push_back( T&& value )
+  {
+    return try_emplace_back( std::move( value ) );
+  }
+
+  T& push_back( const T& value )
+  {
+    return emplace_back( value );
+  }
+
+  T& push_back( T&& value )
+  {
+    return emplace_back( std::move( value ) );
+  }
+
+  // Readers ------------------------------------------------------------------
+
+  // Snapshot of the published prefix, valid until clear(). Producers must not
+  // modify an element through the pointer they were given once it is published.
+  std::span<const T> published() const noexcept
+  {
+    return std::span<const T>( ptr( 0 ), publishedCount() );
+  }
+
+  size_type size() const noexcept
+  {
+    return publishedCount();
+  }
+
+  bool empty() const noexcept
+  {
+    return publishedCount() == 0;
+  }
+
+  // Slots claimed so far, published or not
+  size_type reserved() const noexcept
+  {
+    return std::min( reserved_.load( std::memory_order_relaxed ), Capacity );
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Capacity;
+  }
+
+  const T& operator[]( size_type i ) const
+  {
+    assert( i < publishedCount() );
+    return *ptr( i );
+  }
+
+  // Modifiers ----------------------------------------------------------------
+
+  // Not thread-safe
+  void clear() noexcept
+  {
+    destroyAll();
+    for ( auto& flag : ready_ )
+      flag.store( false, std::memory_order_relaxed );
+    prefix_.store( 0, std::memory_order_relaxed );
+    reserved_.store( 0, std::memory_order_relaxed );
+  }
+
+private:
+
+  T* ptr( size_t i ) noexcept
+  {
+    return reinterpret_cast<T*>( data_ ) + i; // safe on aligned std::byte array of T
+  }
+
+  const T* ptr( size_t i ) const noexcept
+  {
+    return reinterpret_cast<const T*>( data_ ) + i;
+  }
+
+  size_type publishedCount() const noexcept
+  {
+    // Acquiring the cached prefix inherits the visibility established by the
+    // reader that stored it; only the slots beyond it need their flags checked
+    auto cached = prefix_.load( std::memory_order_acquire );
+    const auto limit = reserved();
+    auto count = cached;
+    while ( count < limit && ready_[ count ].load( std::memory_order_acquire ) )
+      ++count;
+    while ( cached < count &&
+            !prefix_.compare_exchange_weak( cached, count, std::memory_order_release, std::memory_order_acquire ) )
+    {
+    }
+    return count;
+  }
+
+  void destroyAll() noexcept
+  {
+    if constexpr ( !std::is_trivially_destructible_v<T> )
+    {
+      const auto limit = reserved();
+      for ( size_t i = 0; i < limit; ++i )
+      {
+        if ( ready_[ i ].load( std::memory_order_relaxed ) )
+          std::destroy_at( ptr( i ) );
+      }
+    }
+  }
+
+private:
+
+  alignas( detail::kCacheLineSize ) std::atomic<size_t> reserved_ = 0; // producers
+  alignas( detail::kCacheLineSize ) mutable std::atomic<size_t> prefix_ = 0; // readers
+  std::array<std::atomic<bool>, Capacity> ready_{};
+  alignas( T ) std::byte data_[ sizeof( T ) * Capacity ];
+
+}; // class concurrent_inplace_vector
+
+} // namespace PKIsensee
+
+#pragma warning(pop)
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,274 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  hashed_inplace_vector.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  inplace_vector that caches its hash value
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "inplace_vector.h"
+
+namespace PKIsensee
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Wraps an inplace_vector and caches its hash. The hash is computed on first
+// request and invalidated by every mutating operation, so repeated lookups of
+// the same key in unordered containers hash it once.
+//
+// Read-only access never invalidates the hash. References and iterators returned
+// by mutating functions must not be used to modify elements after hash() is called;
+// use mutate() to obtain the underlying vector for arbitrary edits.
+
+template < typename T, size_t Capacity, typename Hash = std::hash< inplace_vector< T, Capacity > > >
+class hashed_inplace_vector
+{
+public:
+
+  using vector_type     = inplace_vector<T, Capacity>;
+  using value_type      = typename vector_type::value_type;
+  using size_type       = typename vector_type::size_type;
+  using difference_type = typename vector_type::difference_type;
+  using reference       = typename vector_type::reference;
+  using const_reference = typename vector_type::const_reference;
+  using iterator        = typename vector_type::iterator;
+  using const_iterator  = typename vector_type::const_iterator;
+
+  // Constructors -------------------------------------------------------------
+
+  constexpr hashed_inplace_vector() noexcept = default;
+
+  constexpr explicit hashed_inplace_vector( const vector_type& vec )
+    : vec_( vec )
+  {
+  }
+
+  constexpr explicit hashed_inplace_vector( vector_type&& vec )
+    : vec_( std::move( vec ) )
+  {
+  }
+
+  constexpr hashed_inplace_vector( std::initializer_list<T> iList )
+    : vec_( iList )
+  {
+  }
+
+  // Hash ---------------------------------------------------------------------
+
+  size_t hash() const
+  {
+    if ( !hashValid_ )
+    {
+      hash_ = Hash{}( vec_ );
+      hashValid_ = true;
+    }
+    return hash_;
+  }
+
+  constexpr bool has_cached_hash() const noexcept
+  {
+    return hashValid_;
+  }
+
+  // Read-only access ---------------------------------------------------------
+
+  constexpr const vector_type& vector() const noexcept
+  {
+    return vec_;
+  }
+
+  constexpr operator const vector_type&() const noexcept
+  {
+    return vec_;
+  }
+
+  constexpr const_reference operator[]( size_type i ) const
+  {
+    return vec_[ i ];
+  }
+
+  constexpr const_reference at( size_type i ) const
+  {
+    return vec_.at( i );
+  }
+
+  constexpr const_reference front() const
+  {
+    return vec_.front();
+  }
+
+  constexpr const_reference back() const
+  {
+    return vec_.back();
+  }
+
+  constexpr const_iterator begin() const noexcept
+  {
+    return vec_.begin();
+  }
+
+  constexpr const_iterator end() const noexcept
+  {
+    return vec_.end();
+  }
+
+  constexpr bool empty() const noexcept
+  {
+    return vec_.empty();
+  }
+
+  constexpr size_type size() const noexcept
+  {
+    return vec_.size();
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Capacity;
+  }
+
+  // Modifiers ----------------------------------------------------------------
+
+  constexpr vector_type& mutate() noexcept
+  {
+    // Caller may change the vector arbitrarily; the hash is recomputed on demand
+    invalidate();
+    return vec_;
+  }
+
+  template <typename... Types>
+  constexpr reference emplace_back( Types&&... values )
+  {
+    invalidate();
+    return vec_.emplace_back( std::forward<Types>( values )... );
+  }
+
+  template <typename... Types>
+  constexpr T* try_emplace_back( Types&&... values )
+  {
+    invalidate();
+    return vec_.try_emplace_back( std::forward<Types>( values )... );
+  }
+
+  constexpr reference push_back( const T& value )
+  {
+    invalidate();
+    return vec_.push_back( value );
+  }
+
+  constexpr reference push_back( T&& value )
+  {
+    invalidate();
+    return vec_.push_back( std::move( value ) );
+  }
+
+  constexpr void pop_back()
+  {
+    invalidate();
+    vec_.pop_back();
+  }
+
+  constexpr void set( size_type i, const T& value )
+  {
+    invalidate();
+    vec_[ i ] = value;
+  }
+
+  constexpr iterator insert( const_iterator pos, const T& value )
+  {
+    invalidate();
+    return vec_.insert( pos, value );
+  }
+
+  constexpr iterator erase( const_iterator pos )
+  {
+    invalidate();
+    return vec_.erase( pos );
+  }
+
+  constexpr iterator erase( const_iterator first, const_iterator last )
+  {
+    invalidate();
+    return vec_.erase( first, last );
+  }
+
+  constexpr void resize( size_type count )
+  {
+    invalidate();
+    vec_.resize( count );
+  }
+
+  constexpr void clear() noexcept
+  {
+    invalidate();
+    vec_.clear();
+  }
+
+  constexpr void swap( hashed_inplace_vector& rhs )
+  {
+    vec_.swap( rhs.vec_ );
+    std::swap( hash_, rhs.hash_ );
+    std::swap( hashValid_, rhs.hashValid_ );
+  }
+
+  // Non-member functions -----------------------------------------------------
+
+  friend bool operator==( const hashed_inplace_vector& lhs, const hashed_inplace_vector& rhs )
+  {
+    // Differing cached hashes prove inequality without touching the elements
+    if ( lhs.hashValid_ && rhs.hashValid_ && lhs.hash_ != rhs.hash_ )
+      return false;
+    return lhs.vec_ == rhs.vec_;
+  }
+
+  friend constexpr auto operator<=>( const hashed_inplace_vector& lhs, const hashed_inplace_vector& rhs )
+  {
+    return lhs.vec_ <=> rhs.vec_;
+  }
+
+  friend constexpr void swap( hashed_inplace_vector& lhs, hashed_inplace_vector& rhs )
+  {
+    lhs.swap( rhs );
+  }
+
+private:
+
+  constexpr void invalidate() noexcept
+  {
+    hashValid_ = false;
+  }
+
+private:
+
+  vector_type vec_;
+  mutable size_t hash_ = 0;
+  mutable bool hashValid_ = false;
+
+}; // class hashed_inplace_vector
+
+} // namespace PKIsensee
+
+template < typename T, size_t Capacity, typename Hash >
+struct std::hash<PKIsensee::hashed_inplace_vector<T, Capacity, Hash>>
+{
+  size_t operator()( const PKIsensee::hashed_inplace_vector<T, Capacity, Hash>& vec ) const
+  {
+    return vec.hash();
+  }
+};
+
+///////////////////////////////////////////////////////////////////////////////
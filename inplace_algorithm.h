@@ -0,0 +1,643 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  inplace_algorithm.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  Algorithms specialized for inplace_vector
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <array>
+#include <utility>
+#include "inplace_vector.h"
+
+namespace PKIsensee
+{
+
+// Vectors with at most this capacity are sorted with fixed sorting networks
+inline constexpr size_t kSmallSortCapacity = 32;
+
+namespace detail
+{
+  // Emits the comparators of Batcher's odd-even merge sort for Size elements, where
+  // Size is a power of two. Each comparator orders the pair so the smaller element
+  // lands at the lower index.
+  template < typename Emit >
+  constexpr void oddEvenMergeSort( size_t size, Emit&& emit )
+  {
+    for ( size_t p = 1; p < size; p <<= 1 )
+    {
+      for ( size_t k = p; k >= 1; k >>= 1 )
+      {
+        for ( size_t j = k % p; j + k < size; j += 2 * k )
+        {
+          for ( size_t i = 0; i < std::min( k, size - j - k ); ++i )
+          {
+            if ( ( i + j ) / ( 2 * p ) == ( i + j + k ) / ( 2 * p ) )
+              emit( i + j, i + j + k );
+          }
+        }
+      }
+    }
+  }
+
+  // A network for Count elements is the power-of-two network with every comparator
+  // touching an index >= Count removed; missing elements behave as +infinity,
+  // which those comparators would never move.
+  template < size_t Count >
+  consteval size_t sortingNetworkLength()
+  {
+    size_t length = 0;
+    oddEvenMergeSort( std::bit_ceil( Count ), [&length]( size_t, size_t hi )
+      {
+        if ( hi < Count )
+          ++length;
+      } );
+    return length;
+  }
+
+  template < size_t Count >
+  inline constexpr auto kSortingNetwork = []()
+  {
+    std::array<std::pair<uint8_t, uint8_t>, sortingNetworkLength<Count>()> network{};
+    size_t i = 0;
+    oddEvenMergeSort( std::bit_ceil( Count ), [&network, &i]( size_t lo, size_t hi )
+      {
+        if ( hi < Count )
+          network[ i++ ] = { static_cast<uint8_t>( lo ), static_cast<uint8_t>( hi ) };
+      } );
+    return network;
+  }();
+
+  // Integers only: min/max of equivalent floats (-0.0 and 0.0, or NaN against
+  // anything) returns the same operand twice, which would drop the other value
+  template < typename T, typename Compare >
+  inline constexpr bool isNaturalOrder = std::is_integral_v<T> &&
+    ( std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<T>> ||
+      std::is_same_v<Compare, std::ranges::less> );
+
+  // Branchless compare-exchange. Integers in natural order use min/max, which compile
+  // to cmov; other types select both outputs from a single comparison result, so the
+  // pair is always a permutation of the inputs.
+  template < typename T, typename Compare >
+  constexpr void compareExchange( T& a, T& b, Compare& comp )
+  {
+    const T x = a;
+    const T y = b;
+    if constexpr ( isNaturalOrder<T, Compare> )
+    {
+      a = std::min( x, y );
+      b = std::max( x, y );
+    }
+    else
+    {
+      const bool swapped = comp( y, x );
+      a = swapped ? y : x;
+      b = swapped ? x : y;
+    }
+  }
+
+  template < size_t Count, typename T, typename Compare >
+  constexpr void networkSort( T* elements, Compare& comp )
+  {
+    constexpr auto& network = kSortingNetwork<Count>;
+    [&]<size_t... I>( std::index_sequence<I...> )
+    {
+      ( compareExchange( elements[ network[ I ].first ], elements[ network[ I ].second ], comp ), ... );
+    }( std::make_index_sequence<network.size()>{} );
+  }
+
+  // Selects the straight-line network matching the runtime element count
+  template < size_t Capacity, typename T, typename Compare >
+  void networkSort( T* elements, size_t count, Compare& comp )
+  {
+    assert( count <= Capacity );
+    static constexpr auto kNetworks = []<size_t... N>( std::index_sequence<N...> )
+    {
+      return std::array<void(*)( T*, Compare& ), sizeof...( N )>{ &networkSort<N, T, Compare>... };
+    }( std::make_index_sequence<Capacity + 1>{} );
+    kNetworks[ count ]( elements, comp );
+  }
+
+  // Stable; efficient for the handful of elements a small inplace_vector holds
+  template < typename T, typename Compare >
+  constexpr void insertionSort( T* first, T* last, Compare& comp )
+  {
+    if ( first == last )
+      return;
+    for ( auto i = first + 1; i != last; ++i )
+    {
+      T value = std::move( *i );
+      auto j = i;
+      for ( ; j != first && comp( value, *( j - 1 ) ); --j )
+        *j = std::move( *( j - 1 ) );
+      *j = std::move( value );
+    }
+  }
+
+  template < typename T >
+  inline constexpr bool isNetworkSortable = std::is_trivially_copyable_v<T>;
+
+  template < typename K >
+  concept RadixSortable = ( std::integral<K> && !std::same_as<K, bool> ) ||
+                          std::same_as<K, float> || std::same_as<K, double>;
+
+  // Maps a key to an unsigned integer with the same ordering
+  template < RadixSortable K >
+  constexpr auto toRadixKey( K key ) noexcept
+  {
+    if constexpr ( std::floating_point<K> )
+    {
+      using U = std::conditional_t<sizeof( K ) == sizeof( uint32_t ), uint32_t, uint64_t>;
+      constexpr U kSignBit = U( 1 ) << ( sizeof( U ) * 8 - 1 );
+      const auto bits = std::bit_cast<U>( key );
+      // Negative values flip every bit to reverse their order; positive values
+      // set the sign bit to sort above all negative values
+      return ( bits & kSignBit ) ? static_cast<U>( ~bits ) : static_cast<U>( bits | kSignBit );
+    }
+    else if constexpr ( std::is_signed_v<K> )
+    {
+      using U = std::make_unsigned_t<K>;
+      constexpr U kSignBit = U( 1 ) << ( sizeof( U ) * 8 - 1 );
+      return static_cast<U>( static_cast<U>( key ) ^ kSignBit );
+    }
+    else
+    {
+      return key;
+    }
+  }
+
+  // Index of the first element of the sorted range [first, first + count) not less
+  // than key. The loop has a fixed trip count of log2(count) and selects the next
+  // half with a conditional move instead of a branch.
+  template < typename T, typename K, typename Compare >
+  size_t branchlessLowerBound( const T* first, size_t count, const K& key, Compare& comp )
+  {
+    if ( count == 0 )
+      return 0;
+    const T* base = first;
+    while ( count > 1 )
+    {
+      const auto half = count / 2;
+      base = comp( base[ half ], key ) ? base + half : base;
+      count -= half;
+    }
+    return static_cast<size_t>( base - first ) + ( comp( *base, key ) ? 1 : 0 );
+  }
+
+  // Smallest unsigned type that can hold every value in [0, MaxValue]
+  template < size_t MaxValue >
+  using IndexFor = std::conditional_t< MaxValue <= std::numeric_limits<uint8_t>::max(), uint8_t,
+                   std::conditional_t< MaxValue <= std::numeric_limits<uint16_t>::max(), uint16_t,
+                   std::conditional_t< MaxValue <= std::numeric_limits<uint32_t>::max(), uint32_t,
+                   size_t > > >;
+
+  // Hints the cache line holding address into L1. Never faults, so address may lie
+  // past the end of the data being searched.
+  inline void prefetch( const void* address ) noexcept
+  {
+#if PKISENSEE_SSE2
+    _mm_prefetch( static_cast<const char*>( address ), _MM_HINT_T0 );
+#elif defined( __GNUC__ )
+    __builtin_prefetch( address );
+#else
+    (void)address;
+#endif
+  }
+
+  // Unlike std::span( vec ), doesn't call data(), which asserts on empty vectors
+  template < typename T, size_t Capacity >
+  std::span<const T> asSpan( const inplace_vector<T, Capacity>& vec ) noexcept
+  {
+    return std::span<const T>( vec.begin(), vec.size() );
+  }
+
+  // Ratio of input sizes beyond which intersection gallops through the larger input
+  inline constexpr size_t kGallopRatio = 32;
+
+  // First element in [first, last) not less than value, found by exponential search
+  // from first; O(log d) where d is the distance to the result
+  template < typename T, typename Compare >
+  const T* gallop( const T* first, const T* last, const T& value, Compare& comp )
+  {
+    const auto size = static_cast<size_t>( last - first );
+    size_t bound = 1;
+    while ( bound < size && comp( first[ bound ], value ) )
+      bound *= 2;
+    return std::lower_bound( first + bound / 2, first + std::min( bound + 1, size ), value, comp );
+  }
+
+  // Appends to dest. Unchecked appends are used when the caller has verified that
+  // the worst-case output fits; checked appends return false on overflow.
+  template < bool Checked, typename T, size_t Capacity >
+  bool append( inplace_vector<T, Capacity>& dest, const T& value )
+  {
+    if constexpr ( Checked )
+      return dest.try_push_back( value ) != nullptr;
+    else
+    {
+      dest.unchecked_push_back( value );
+      return true;
+    }
+  }
+
+  template < bool Checked, typename T, size_t Capacity, typename Compare >
+  bool mergeInto( std::span<const T> a, std::span<const T> b, inplace_vector<T, Capacity>& dest,
+                  Compare& comp )
+  {
+    size_t i = 0;
+    size_t j = 0;
+    while ( i < a.size() && j < b.size() )
+    {
+      // Stable: equivalent elements from a precede those from b
+      const bool takeB = comp( b[ j ], a[ i ] );
+      if ( !append<Checked>( dest, takeB ? b[ j ] : a[ i ] ) )
+        return false;
+      j += takeB;
+      i += !takeB;
+    }
+    for ( ; i < a.size(); ++i )
+      if ( !append<Checked>( dest, a[ i ] ) )
+        return false;
+    for ( ; j < b.size(); ++j )
+      if ( !append<Checked>( dest, b[ j ] ) )
+        return false;
+    return true;
+  }
+
+  template < bool Checked, typename T, size_t Capacity, typename Compare >
+  bool unionInto( std::span<const T> a, std::span<const T> b, inplace_vector<T, Capacity>& dest,
+                  Compare& comp )
+  {
+    size_t i = 0;
+    size_t j = 0;
+    while ( i < a.size() && j < b.size() )
+    {
+      const bool aLess = comp( a[ i ], b[ j ] );
+      const bool bLess = comp( b[ j ], a[ i ] );
+      if ( !append<Checked>( dest, bLess ? b[ j ] : a[ i ] ) )
+        return false;
+      i += !bLess;
+      j += !aLess;
+    }
+    for ( ; i < a.size(); ++i )
+      if ( !append<Checked>( dest, a[ i ] ) )
+        return false;
+    for ( ; j < b.size(); ++j )
+      if ( !append<Checked>( dest, b[ j ] ) )
+        return false;
+    return true;
+  }
+
+  template < bool Checked, typename T, size_t Capacity, typename Compare >
+  bool differenceInto( std::span<const T> a, std::span<const T> b, inplace_vector<T, Capacity>& dest,
+                       Compare& comp )
+  {
+    size_t j = 0;
+    for ( size_t i = 0; i < a.size(); ++i )
+    {
+      while ( j < b.size() && comp( b[ j ], a[ i ] ) )
+        ++j;
+      if ( j < b.size() && !comp( a[ i ], b[ j ] ) )
+        continue; // present in both
+      if ( !append<Checked>( dest, a[ i ] ) )
+        return false;
+    }
+    return true;
+  }
+
+  template < typename T, typename Compare >
+  inline constexpr bool isSimdIntersectable = PKISENSEE_SSE2 && std::is_integral_v<T> &&
+                                              sizeof( T ) == 4 && isNaturalOrder<T, Compare>;
+
+  template < bool Checked, typename T, size_t Capacity, typename Compare >
+  bool intersectionInto( std::span<const T> a, std::span<const T> b, inplace_vector<T, Capacity>& dest,
+                         Compare& comp )
+  {
+    // Skewed sizes: gallop through the larger input for each element of the smaller
+    if ( b.size() >= kGallopRatio * a.size() )
+    {
+      auto pos = b.data();
+      const auto last = b.data() + b.size();
+      for ( const auto& value : a )
+      {
+        pos = gallop( pos, last, value, comp );
+        if ( pos == last )
+          break;
+        if ( !comp( value, *pos ) && !append<Checked>( dest, value ) )
+          return false;
+      }
+      return true;
+    }
+    if ( a.size() >= kGallopRatio * b.size() )
+    {
+      auto pos = a.data();
+      const auto last = a.data() + a.size();
+      for ( const auto& value : b )
+      {
+        pos = gallop( pos, last, value, comp );
+        if ( pos == last )
+          break;
+        if ( !comp( value, *pos ) && !append<Checked>( dest, *pos ) )
+          return false;
+      }
+      return true;
+    }
+
+    size_t i = 0;
+    size_t j = 0;
+#if PKISENSEE_SSE2
+    if constexpr ( isSimdIntersectable<T, Compare> )
+    {
+      // Compare blocks of four against all four rotations of the other block, then
+      // advance whichever block has the smaller maximum (both if equal)
+      while ( i + 4 <= a.size() && j + 4 <= b.size() )
+      {
+        const auto va = _mm_loadu_si128( reinterpret_cast<const __m128i*>( a.data() + i ) );
+        const auto vb = _mm_loadu_si128( reinterpret_cast<const __m128i*>( b.data() + j ) );
+        auto match = _mm_cmpeq_epi32( va, vb );
+        match = _mm_or_si128( match, _mm_cmpeq_epi32( va, _mm_shuffle_epi32( vb, _MM_SHUFFLE( 0, 3, 2, 1 ) ) ) );
+        match = _mm_or_si128( match, _mm_cmpeq_epi32( va, _mm_shuffle_epi32( vb, _MM_SHUFFLE( 1, 0, 3, 2 ) ) ) );
+        match = _mm_or_si128( match, _mm_cmpeq_epi32( va, _mm_shuffle_epi32( vb, _MM_SHUFFLE( 2, 1, 0, 3 ) ) ) );
+        for ( auto mask = static_cast<unsigned>( _mm_movemask_ps( _mm_castsi128_ps( match ) ) ); 
+              mask != 0; mask &= mask - 1 )
+        {
+          if ( !append<Checked>( dest, a[ i + static_cast<size_t>( std::countr_zero( mask ) ) ] ) )
+            return false;
+        }
+        const auto aMax = a[ i + 3 ];
+        const auto bMax = b[ j + 3 ];
+        i += ( aMax <= bMax ) ? 4 : 0;
+        j += ( bMax <= aMax ) ? 4 : 0;
+      }
+    }
+#endif
+    while ( i < a.size() && j < b.size() )
+    {
+      if ( comp( a[ i ], b[ j ] ) )
+        ++i;
+      else if ( comp( b[ j ], a[ i ] ) )
+        ++j;
+      else
+      {
+        if ( !append<Checked>( dest, a[ i ] ) )
+          return false;
+        ++i;
+        ++j;
+      }
+    }
+    return true;
+  }
+
+  // Runs op unchecked if worstCase elements fit in dest, otherwise checked. On overflow
+  // dest is restored to its original size and false is returned.
+  template < typename T, size_t Capacity, typename Op >
+  bool tryAppendInto( inplace_vector<T, Capacity>& dest, size_t worstCase, Op&& op )
+  {
+    const auto originalSize = dest.size();
+    if ( worstCase <= dest.capacity() - originalSize )
+      return op( std::false_type{} );
+    if ( op( std::true_type{} ) )
+      return true;
+    dest.erase( dest.begin() + originalSize, dest.end() );
+    return false;
+  }
+
+}; // namespace detail
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Sorting. Small trivially copyable vectors are sorted with a branchless sorting
+// network chosen at compile time for each possible size up to Capacity; the only
+// branch is the dispatch on size(). Larger vectors use the standard algorithms.
+
+template < typename T, size_t Capacity, typename Compare = std::less<> >
+void sort( inplace_vector<T, Capacity>& vec, Compare comp = {} )
+{
+  if constexpr ( Capacity <= kSmallSortCapacity && detail::isNetworkSortable<T> )
+    detail::networkSort<Capacity>( vec.begin(), vec.size(), comp );
+  else
+    std::sort( vec.begin(), vec.end(), comp );
+}
+
+template < typename T, size_t Capacity, typename Compare = std::less<> >
+void stable_sort( inplace_vector<T, Capacity>& vec, Compare comp = {} )
+{
+  // Sorting networks aren't stable, so small vectors use insertion sort.
+  // std::stable_sort may allocate a temporary buffer for large vectors.
+  if constexpr ( Capacity <= kSmallSortCapacity )
+    detail::insertionSort( vec.begin(), vec.end(), comp );
+  else
+    std::stable_sort( vec.begin(), vec.end(), comp );
+}
+
+template < typename T, size_t Capacity, typename Compare = std::less<> >
+void nth_element( inplace_vector<T, Capacity>& vec, size_t nth, Compare comp = {} )
+{
+  // Rearranges vec so vec[nth] is the element that would be there if vec were sorted.
+  // A full network sort is cheaper than partitioning for small vectors.
+  assert( nth <= vec.size() );
+  if constexpr ( Capacity <= kSmallSortCapacity && detail::isNetworkSortable<T> )
+    detail::networkSort<Capacity>( vec.begin(), vec.size(), comp );
+  else
+    std::nth_element( vec.begin(), vec.begin() + nth, vec.end(), comp );
+}
+
+template < typename T, size_t Capacity, typename Compare = std::less<> >
+const T& median( inplace_vector<T, Capacity>& vec, Compare comp = {} )
+{
+  // Returns the upper median; reorders vec as nth_element() does
+  assert( !vec.empty() );
+  const auto mid = vec.size() / 2;
+  nth_element( vec, mid, comp );
+  return vec[ mid ];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// LSD radix sort on 8-bit digits for integer, float and double keys, or for any T
+// with a projection yielding such a key. Stable. All digit histograms are built
+// in a single read pass, and a pass is skipped when every key shares its digit.
+// scratch must be a different vector; its contents are replaced. No allocations.
+
+template < typename T, size_t Capacity, typename Projection = std::identity >
+  requires( detail::RadixSortable< std::remove_cvref_t< std::invoke_result_t< Projection&, const T& > > > &&
+            std::copyable<T> )
+void radix_sort( inplace_vector<T, Capacity>& vec, inplace_vector<T, Capacity>& scratch,
+                 Projection proj = {} )
+{
+  assert( &vec != &scratch );
+  const auto getKey = [&proj]( const T& elem )
+  {
+    return detail::toRadixKey( std::invoke( proj, elem ) );
+  };
+  using Key   = decltype( getKey( std::declval<const T&>() ) );
+  using Count = std::conditional_t< Capacity <= std::numeric_limits<uint32_t>::max(), uint32_t, size_t >;
+  constexpr size_t kPasses  = sizeof( Key );
+  constexpr size_t kBuckets = 256;
+
+  const auto count = vec.size();
+  if ( count < 2 )
+    return;
+
+  std::array<std::array<Count, kBuckets>, kPasses> histograms{};
+  for ( const auto& elem : vec )
+  {
+    const auto key = getKey( elem );
+    for ( size_t pass = 0; pass < kPasses; ++pass )
+      ++histograms[ pass ][ ( key >> ( pass * 8 ) ) & 0xFF ];
+  }
+
+  const auto firstKey = getKey( vec.front() );
+  T* src = vec.begin();
+  T* dst = nullptr;
+  for ( size_t pass = 0; pass < kPasses; ++pass )
+  {
+    const auto shift = pass * 8;
+    auto& offsets = histograms[ pass ];
+    if ( offsets[ ( firstKey >> shift ) & 0xFF ] == count )
+      continue; // all keys land in one bucket; order is unchanged
+
+    if ( dst == nullptr )
+    {
+      // Deferred until a pass actually moves elements
+      scratch.assign( vec.begin(), vec.end() );
+      dst = scratch.begin();
+    }
+
+    // Convert counts to starting offsets
+    Count offset = 0;
+    for ( auto& bucket : offsets )
+    {
+      const auto bucketCount = bucket;
+      bucket = offset;
+      offset += bucketCount;
+    }
+
+    for ( size_t i = 0; i < count; ++i )
+      dst[ offsets[ ( getKey( src[ i ] ) >> shift ) & 0xFF ]++ ] = std::move( src[ i ] );
+    std::swap( src, dst );
+  }
+
+  if ( src != vec.begin() )
+    std::move( src, src + count, vec.begin() );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Merge and set operations on sorted vectors, appending the result to dest.
+// Set operations require inputs that are sorted and free of duplicates, e.g. the
+// output of sort_unique(). The output bound is checked once up front; when it fits,
+// elements are constructed in dest without per-element capacity checks.
+//
+// try_ versions return false on overflow and leave dest unchanged. Other versions
+// throw std::bad_alloc on overflow, matching emplace_back().
+//
+// Intersection of 32-bit integer keys compares four-element blocks with SSE2, and
+// inputs whose sizes differ by more than kGallopRatio use galloping search.
+
+template < typename T, size_t CapacityA, size_t CapacityB, size_t Capacity, typename Compare = std::less<> >
+bool try_merge_into( const inplace_vector<T, CapacityA>& a, const inplace_vector<T, CapacityB>& b,
+                     inplace_vector<T, Capacity>& dest, Compare comp = {} )
+{
+  // Merge output size is exact, so overflow is detected before writing anything
+  if ( a.size() + b.size() > dest.capacity() - dest.size() )
+    return false;
+  return detail::mergeInto<false>( detail::asSpan( a ), detail::asSpan( b ), dest, comp );
+}
+
+template < typename T, size_t CapacityA, size_t CapacityB, size_t Capacity, typename Compare = std::less<> >
+bool try_set_union_into( const inplace_vector<T, CapacityA>& a, const inplace_vector<T, CapacityB>& b,
+                         inplace_vector<T, Capacity>& dest, Compare comp = {} )
+{
+  return detail::tryAppendInto( dest, a.size() + b.size(), [&]( auto checked )
+    {
+      return detail::unionInto<decltype( checked )::value>( detail::asSpan( a ), detail::asSpan( b ),
+                                                            dest, comp );
+    } );
+}
+
+template < typename T, size_t CapacityA, size_t CapacityB, size_t Capacity, typename Compare = std::less<> >
+bool try_set_intersection_into( const inplace_vector<T, CapacityA>& a, const inplace_vector<T, CapacityB>& b,
+                                inplace_vector<T, Capacity>& dest, Compare comp = {} )
+{
+  return detail::tryAppendInto( dest, std::min( a.size(), b.size() ), [&]( auto checked )
+    {
+      return detail::intersectionInto<decltype( checked )::value>( detail::asSpan( a ), detail::asSpan( b ),
+                                                                   dest, comp );
+    } );
+}
+
+template < typename T, size_t CapacityA, size_t CapacityB, size_t Capacity, typename Compare = std::less<> >
+bool try_set_difference_into( const inplace_vector<T, CapacityA>& a, const inplace_vector<T, CapacityB>& b,
+                              inplace_vector<T, Capacity>& dest, Compare comp = {} )
+{
+  return detail::tryAppendInto( dest, a.size(), [&]( auto checked )
+    {
+      return detail::differenceInto<decltype( checked )::value>( detail::asSpan( a ), detail::asSpan( b ),
+                                                                 dest, comp );
+    } );
+}
+
+template < typename T, size_t CapacityA, size_t CapacityB, size_t Capacity, typename Compare = std::less<> >
+void merge_into( const inplace_vector<T, CapacityA>& a, const inplace_vector<T, CapacityB>& b,
+                 inplace_vector<T, Capacity>& dest, Compare comp = {} )
+{
+  if ( !try_merge_into( a, b, dest, comp ) )
+    throw std::bad_alloc();
+}
+
+template < typename T, size_t CapacityA, size_t CapacityB, size_t Capacity, typename Compare = std::less<> >
+void set_union_into( const inplace_vector<T, CapacityA>& a, const inplace_vector<T, CapacityB>& b,
+                     inplace_vector<T, Capacity>& dest, Compare comp = {} )
+{
+  if ( !try_set_union_into( a, b, dest, comp ) )
+    throw std::bad_alloc();
+}
+
+template < typename T, size_t CapacityA, size_t CapacityB, size_t Capacity, typename Compare = std::less<> >
+void set_intersection_into( const inplace_vector<T, CapacityA>& a, const inplace_vector<T, CapacityB>& b,
+                            inplace_vector<T, Capacity>& dest, Compare comp = {} )
+{
+  if ( !try_set_intersection_into( a, b, dest, comp ) )
+    throw std::bad_alloc();
+}
+
+template < typename T, size_t CapacityA, size_t CapacityB, size_t Capacity, typename Compare = std::less<> >
+void set_difference_into( const inplace_vector<T, CapacityA>& a, const inplace_vector<T, CapacityB>& b,
+                          inplace_vector<T, Capacity>& dest, Compare comp = {} )
+{
+  if ( !try_set_difference_into( a, b, dest, comp ) )
+    throw std::bad_alloc();
+}
+
+template < typename T, size_t Capacity, typename Compare = std::less<> >
+auto sort_unique( inplace_vector<T, Capacity>& vec, Compare comp = {} ) -> 
+  inplace_vector<T, Capacity>::size_type
+{
+  // Sorts vec and removes equivalent elements; returns the number removed
+  sort( vec, comp );
+  const auto it = std::unique( vec.begin(), vec.end(), [&comp]( const T& lhs, const T& rhs )
+    {
+      return !comp( lhs, rhs ); // sorted, so lhs <= rhs; equivalent unless lhs < rhs
+    } );
+  const auto countRemoved = std::distance( it, vec.end() );
+  vec.erase( it, vec.end() );
+  return detail::asSizeType( countRemoved );
+}
+
+} // namespace PKIsensee
+
+///////////////////////////////////////////////////////////////////////////////
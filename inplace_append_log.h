@@ -0,0 +1,212 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  inplace_append_log.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  Single-writer append-only log with lock-free readers
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <span>
+#include "inplace_vector.h"
+
+#pragma warning(push)
+#pragma warning(disable: 26495) // "data_ is uninitialized", by design
+#pragma warning(disable: 4324)  // "structure was padded due to alignment specifier", by design
+
+namespace PKIsensee
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Append-only array of at most Capacity elements with one writer thread and any
+// number of reader threads. The writer constructs each element and only then
+// stores the new size with release semantics. A reader's acquire load of the size
+// therefore covers fully constructed elements only. Published elements never move
+// or change, so readers can use span() without copying or locking.
+//
+// try_emplace_back() and try_append() publish immediately. stage() constructs
+// without publishing, and publish() then releases a whole batch with one store.
+// try_ functions return nullptr or a short count when the log is full or sealed;
+// emplace_back() throws std::bad_alloc.
+//
+// seal() marks the log complete so readers know no more elements will appear.
+// reset() destroys the contents and reopens the log for reuse. It must not overlap
+// readers, who would see storage being reused.
+
+template < typename T, size_t Capacity >
+class inplace_append_log
+{
+public:
+
+  using value_type      = T;
+  using size_type       = size_t;
+  using const_reference = const T&;
+
+  // Constructors -------------------------------------------------------------
+
+  inplace_append_log() = default;
+
+  inplace_append_log( const inplace_append_log& ) = delete;
+  inplace_append_log& operator=( const inplace_append_log& ) = delete;
+
+  ~inplace_append_log()
+  {
+    std::destroy_n( ptr( 0 ), staged_ );
+  }
+
+  // Writer -------------------------------------------------------------------
+
+  // Constructs an element and publishes it along with anything staged. Returns
+  // nullptr if the log is full or sealed.
+  template <typename... Types>
+  const T* try_emplace_back( Types&&... values )
+  {
+    const auto p = stage( std::forward<Types>( values )... );
+    if ( p != nullptr )
+      publish();
+    return p;
+  }
+
+  template <typename... Types>
+  const T& emplace_back( Types&&... values )
+  {
+    const auto p = try_emplace_back( std::forward<Types>( values )... );
+    if ( p == nullptr )
+      throw std::bad_alloc();
+    return *p;
+  }
+
+  const T* try_push_back( const T& value )
+  {
+    return try_emplace_back( value );
+  }
+
+  const T* try_push_back( T&& value )
+  {
+    return try_emplace_back( std::move( value ) );
+  }
+
+  // Copies the longest prefix of values that fits and publishes it with one store.
+  // Returns the number appended.
+  size_type try_append( std::span<const T> values )
+  {
+    if ( sealed_.load( std::memory_order_relaxed ) )
+      return 0;
+    const auto count = std::min( values.size(), Capacity - staged_ );
+    std::uninitialized_copy_n( values.begin(), count, ptr( staged_ ) );
+    staged_ += count;
+    publish();
+    return count;
+  }
+
+  // Constructs an element that readers can't see until publish(). Returns nullptr
+  // if the log is full or sealed.
+  template <typename... Types>
+  const T* stage( Types&&... values )
+  {
+    if ( staged_ == Capacity || sealed_.load( std::memory_order_relaxed ) )
+      return nullptr;
+    const auto p = std::construct_at( ptr( staged_ ), std::forward<Types>( values )... );
+    ++staged_;
+    return p;
+  }
+
+  // Makes every staged element visible to readers
+  void publish() noexcept
+  {
+    size_.store( staged_, std::memory_order_release );
+  }
+
+  // Publishes anything staged and closes the log to further appends
+  void seal() noexcept
+  {
+    publish();
+    sealed_.store( true, std::memory_order_release );
+  }
+
+  // Destroys every element and reopens the log. Must not overlap readers.
+  void reset() noexcept
+  {
+    size_.store( 0, std::memory_order_relaxed );
+    std::destroy_n( ptr( 0 ), staged_ );
+    staged_ = 0;
+    sealed_.store( false, std::memory_order_release );
+  }
+
+  // Readers ------------------------------------------------------------------
+
+  // Published prefix; elements in it stay valid and unchanged until reset()
+  std::span<const T> span() const noexcept
+  {
+    return std::span<const T>( ptr( 0 ), size() );
+  }
+
+  size_type size() const noexcept
+  {
+    return size_.load( std::memory_order_acquire );
+  }
+
+  bool empty() const noexcept
+  {
+    return size() == 0;
+  }
+
+  // True once seal() has run; a span() taken afterward holds every element
+  bool sealed() const noexcept
+  {
+    return sealed_.load( std::memory_order_acquire );
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Capacity;
+  }
+
+  // i must be below a size() already observed by this thread
+  const T& operator[]( size_type i ) const noexcept
+  {
+    assert( i < Capacity );
+    return *ptr( i );
+  }
+
+private:
+
+  T* ptr( size_t i ) noexcept
+  {
+    return reinterpret_cast<T*>( data_ ) + i; // safe on aligned std::byte array of T
+  }
+
+  const T* ptr( size_t i ) const noexcept
+  {
+    return reinterpret_cast<const T*>( data_ ) + i;
+  }
+
+private:
+
+  alignas( detail::kCacheLineSize ) std::atomic<size_t> size_ = 0; // published count, read by readers
+  std::atomic<bool> sealed_ = false;
+  size_t staged_ = 0;                                               // constructed count, writer only
+  alignas( T ) std::byte data_[ sizeof( T ) * Capacity ];
+
+}; // class inplace_append_log
+
+} // namespace PKIsensee
+
+#pragma warning(pop)
+
+///////////////////////////////////////////////////////////////////////////////
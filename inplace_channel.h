@@ -0,0 +1,572 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  inplace_channel.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  Coroutine-aware bounded channel and single-threaded executor
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <array>
+#include <coroutine>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include "inplace_vector.h"
+
+#pragma warning(push)
+#pragma warning(disable: 26495) // "data_ is uninitialized", by design
+
+namespace PKIsensee
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// FIFO of suspended coroutines, held in a fixed ring of Capacity handles. post()
+// queues a handle and run() resumes queued coroutines until none remain, including
+// any posted while running. co_await schedule() moves the awaiting coroutine to the
+// back of the queue. post() throws std::bad_alloc when the ring is full; try_post()
+// returns false.
+//
+// By default the executor is single-threaded. With ThreadSafe, a spin lock guards
+// the ring, so other threads may post to it, e.g. a thread-safe inplace_channel
+// waking a coroutine. Coroutines are always resumed outside the lock.
+
+template < size_t Capacity = 256, bool ThreadSafe = false >
+class inplace_executor
+{
+  static_assert( Capacity > 0, "inplace_executor requires Capacity > 0" );
+
+  using lock_type = std::conditional_t<ThreadSafe, detail::spinLock, detail::nullLock>;
+
+public:
+
+  using size_type = size_t;
+
+  // Constructors -------------------------------------------------------------
+
+  inplace_executor() = default;
+
+  inplace_executor( const inplace_executor& ) = delete;
+  inplace_executor& operator=( const inplace_executor& ) = delete;
+
+  // Scheduling ---------------------------------------------------------------
+
+  bool try_post( std::coroutine_handle<> handle ) noexcept
+  {
+    std::scoped_lock lock( lock_ );
+    if ( count_ == Capacity )
+      return false;
+    ring_[ ( head_ + count_ ) % Capacity ] = handle;
+    ++count_;
+    return true;
+  }
+
+  void post( std::coroutine_handle<> handle )
+  {
+    if ( !try_post( handle ) )
+      throw std::bad_alloc();
+  }
+
+  // Awaitable that requeues the caller
+  auto schedule() noexcept
+  {
+    struct awaiter
+    {
+      inplace_executor& executor;
+
+      bool await_ready() const noexcept
+      {
+        return false;
+      }
+
+      void await_suspend( std::coroutine_handle<> handle )
+      {
+        executor.post( handle );
+      }
+
+      void await_resume() const noexcept
+      {
+      }
+    };
+    return awaiter{ *this };
+  }
+
+  // Running ------------------------------------------------------------------
+
+  // Resumes the oldest queued coroutine; returns false if none was queued
+  bool run_one()
+  {
+    std::coroutine_handle<> handle;
+    {
+      std::scoped_lock lock( lock_ );
+      if ( count_ == 0 )
+        return false;
+      handle = ring_[ head_ ];
+      head_ = ( head_ + 1 ) % Capacity;
+      --count_;
+    }
+    handle.resume();
+    return true;
+  }
+
+  // Resumes coroutines until the queue is empty; returns the number resumed
+  size_type run()
+  {
+    size_type resumed = 0;
+    while ( run_one() )
+      ++resumed;
+    return resumed;
+  }
+
+  // Observers ----------------------------------------------------------------
+
+  size_type size() const noexcept
+  {
+    std::scoped_lock lock( lock_ );
+    return count_;
+  }
+
+  bool empty() const noexcept
+  {
+    return size() == 0;
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Capacity;
+  }
+
+private:
+
+  mutable lock_type lock_;
+  std::array<std::coroutine_handle<>, Capacity> ring_{};
+  size_t head_ = 0;
+  size_t count_ = 0;
+
+}; // class inplace_executor
+
+namespace detail
+{
+  // Whether an executor may be posted to from several threads. Other executor types
+  // handed to a thread-safe inplace_channel must be thread-safe themselves.
+  template < typename Executor >
+  inline constexpr bool isSharedExecutor = true;
+
+  template < size_t Capacity, bool ThreadSafe >
+  inline constexpr bool isSharedExecutor<inplace_executor<Capacity, ThreadSafe>> = ThreadSafe;
+
+}; // namespace detail
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Bounded FIFO channel for coroutines. co_await send( value ) suspends while the
+// channel is full, and co_await receive() suspends while it is empty. Values live
+// in a ring of Capacity elements, constructed in place in an aligned std::byte
+// array as in inplace_vector. Suspended senders and receivers are linked through
+// nodes inside their own awaiters, which live in the coroutine frames. The channel
+// therefore never allocates, however many coroutines wait on it. Waiters are
+// served in FIFO order.
+//
+// A coroutine woken by the other side is posted to the executor given at
+// construction. It is resumed inline on the waking thread if none was given, or if
+// the executor's queue is full, so a wakeup is never lost. close()
+// wakes every waiter. Pending sends then yield false, and receives yield nullopt
+// once the buffered values run out. try_send() and try_receive() never suspend.
+//
+// With ThreadSafe, a spin lock guards the channel, so coroutines on different
+// threads may share it. Resumption always happens after the lock is released. Any
+// thread may then post to the executor, so it must be thread-safe too, e.g. an
+// inplace_executor with ThreadSafe. T must be nothrow move constructible.
+
+template < typename T, size_t Capacity, bool ThreadSafe = false >
+class inplace_channel
+{
+  static_assert( Capacity > 0, "inplace_channel requires Capacity > 0" );
+  static_assert( std::is_nothrow_move_constructible_v<T>, "inplace_channel requires nothrow move" );
+
+  using lock_type = std::conditional_t<ThreadSafe, detail::spinLock, detail::nullLock>;
+
+  // Intrusive FIFO link embedded in each suspended awaiter
+  struct waiter
+  {
+    waiter* next = nullptr;
+    std::coroutine_handle<> handle;
+  };
+
+  struct waiterList
+  {
+    waiter* head = nullptr;
+    waiter* tail = nullptr;
+
+    bool empty() const noexcept
+    {
+      return head == nullptr;
+    }
+
+    void push_back( waiter* w ) noexcept
+    {
+      w->next = nullptr;
+      ( tail == nullptr ? head : tail->next ) = w;
+      tail = w;
+    }
+
+    waiter* pop_front() noexcept
+    {
+      const auto w = head;
+      head = w->next;
+      if ( head == nullptr )
+        tail = nullptr;
+      return w;
+    }
+  };
+
+public:
+
+  using value_type = T;
+  using size_type  = size_t;
+
+  /////////////////////////////////////////////////////////////////////////////
+  //
+  // Returned by send(); co_await yields true if the value was delivered, false if
+  // the channel was closed first
+
+  class send_awaiter : private waiter
+  {
+  public:
+
+    send_awaiter( const send_awaiter& ) = delete;
+    send_awaiter& operator=( const send_awaiter& ) = delete;
+
+    bool await_ready()
+    {
+      waiter* woken = nullptr;
+      bool done;
+      {
+        std::scoped_lock lock( channel_.lock_ );
+        done = finish( woken );
+      }
+      channel_.wake( woken );
+      return done;
+    }
+
+    bool await_suspend( std::coroutine_handle<> handle )
+    {
+      this->handle = handle;
+      waiter* woken = nullptr;
+      {
+        std::scoped_lock lock( channel_.lock_ );
+        if ( !finish( woken ) )
+        {
+          channel_.senders_.push_back( this );
+          return true; // may already be resuming elsewhere; don't touch *this
+        }
+      }
+      channel_.wake( woken );
+      return false;
+    }
+
+    bool await_resume() const noexcept
+    {
+      return sent_;
+    }
+
+  private:
+
+    friend class inplace_channel;
+
+    send_awaiter( inplace_channel& channel, T&& value ) noexcept
+      : channel_( channel ),
+        value_( std::move( value ) )
+    {
+    }
+
+    // Caller holds the lock; returns false if the sender must wait. A receiver
+    // handed the value is returned in woken, to be resumed once the lock drops.
+    bool finish( waiter*& woken ) noexcept
+    {
+      if ( channel_.closed_ )
+        return true;
+      sent_ = channel_.deliver( std::move( value_ ), woken );
+      return sent_;
+    }
+
+  private:
+
+    inplace_channel& channel_;
+    T value_;
+    bool sent_ = false;
+
+  }; // class send_awaiter
+
+  /////////////////////////////////////////////////////////////////////////////
+  //
+  // Returned by receive(); co_await yields the oldest value, or nullopt once the
+  // channel is closed and drained
+
+  class receive_awaiter : private waiter
+  {
+  public:
+
+    receive_awaiter( const receive_awaiter& ) = delete;
+    receive_awaiter& operator=( const receive_awaiter& ) = delete;
+
+    bool await_ready()
+    {
+      waiter* woken = nullptr;
+      bool done;
+      {
+        std::scoped_lock lock( channel_.lock_ );
+        done = finish( woken );
+      }
+      channel_.wake( woken );
+      return done;
+    }
+
+    bool await_suspend( std::coroutine_handle<> handle )
+    {
+      this->handle = handle;
+      waiter* woken = nullptr;
+      {
+        std::scoped_lock lock( channel_.lock_ );
+        if ( !finish( woken ) )
+        {
+          channel_.receivers_.push_back( this );
+          return true; // may already be resuming elsewhere; don't touch *this
+        }
+      }
+      channel_.wake( woken );
+      return false;
+    }
+
+    std::optional<T> await_resume() noexcept
+    {
+      return std::move( value_ );
+    }
+
+  private:
+
+    friend class inplace_channel;
+
+    explicit receive_awaiter( inplace_channel& channel ) noexcept
+      : channel_( channel )
+    {
+    }
+
+    // Caller holds the lock; returns false if the receiver must wait. A sender
+    // whose value was buffered is returned in woken.
+    bool finish( waiter*& woken ) noexcept
+    {
+      return channel_.take( value_, woken ) || channel_.closed_;
+    }
+
+  private:
+
+    inplace_channel& channel_;
+    std::optional<T> value_;
+
+  }; // class receive_awaiter
+
+  // Constructors -------------------------------------------------------------
+
+  // Woken coroutines are resumed inline on the thread that wakes them
+  inplace_channel() = default;
+
+  // Woken coroutines are passed to executor.try_post( std::coroutine_handle<> ),
+  // which returns false if the executor can't take them
+  template < typename Executor >
+  explicit inplace_channel( Executor& executor ) noexcept
+    : executor_( std::addressof( executor ) ),
+      tryPost_( []( void* ex, std::coroutine_handle<> handle )
+        {
+          return static_cast<Executor*>( ex )->try_post( handle );
+        } )
+  {
+    static_assert( !ThreadSafe || detail::isSharedExecutor<Executor>,
+                   "a thread-safe inplace_channel requires a thread-safe executor" );
+  }
+
+  inplace_channel( const inplace_channel& ) = delete;
+  inplace_channel& operator=( const inplace_channel& ) = delete;
+
+  ~inplace_channel()
+  {
+    assert( senders_.empty() && receivers_.empty() );
+    for ( ; count_ > 0; --count_, head_ = ( head_ + 1 ) % Capacity )
+      std::destroy_at( ptr( head_ ) );
+  }
+
+  // Coroutine interface ------------------------------------------------------
+
+  [[nodiscard]] send_awaiter send( T value ) noexcept
+  {
+    return send_awaiter( *this, std::move( value ) );
+  }
+
+  [[nodiscard]] receive_awaiter receive() noexcept
+  {
+    return receive_awaiter( *this );
+  }
+
+  // Non-suspending interface -------------------------------------------------
+
+  // Returns false if the channel is full or closed
+  bool try_send( T value )
+  {
+    waiter* woken = nullptr;
+    bool sent;
+    {
+      std::scoped_lock lock( lock_ );
+      sent = !closed_ && deliver( std::move( value ), woken );
+    }
+    wake( woken );
+    return sent;
+  }
+
+  // Returns false if the channel is empty
+  bool try_receive( T& value )
+  {
+    waiter* woken = nullptr;
+    std::optional<T> received;
+    {
+      std::scoped_lock lock( lock_ );
+      if ( !take( received, woken ) )
+        return false;
+    }
+    wake( woken );
+    value = std::move( *received );
+    return true;
+  }
+
+  // Wakes every waiter; later sends fail and receives drain what is buffered
+  void close()
+  {
+    waiterList senders;
+    waiterList receivers;
+    {
+      std::scoped_lock lock( lock_ );
+      closed_ = true;
+      std::swap( senders, senders_ );
+      std::swap( receivers, receivers_ );
+    }
+    wakeAll( senders );
+    wakeAll( receivers );
+  }
+
+  // Observers ----------------------------------------------------------------
+
+  size_type size() const noexcept
+  {
+    std::scoped_lock lock( lock_ );
+    return count_;
+  }
+
+  bool empty() const noexcept
+  {
+    return size() == 0;
+  }
+
+  bool closed() const noexcept
+  {
+    std::scoped_lock lock( lock_ );
+    return closed_;
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Capacity;
+  }
+
+private:
+
+  T* ptr( size_t i ) noexcept
+  {
+    return reinterpret_cast<T*>( data_ ) + i; // safe on aligned std::byte array of T
+  }
+
+  // Caller holds the lock. Hands value to the oldest waiting receiver or buffers
+  // it; returns false if the buffer is full.
+  bool deliver( T&& value, waiter*& woken ) noexcept
+  {
+    if ( !receivers_.empty() )
+    {
+      auto receiver = static_cast<receive_awaiter*>( receivers_.pop_front() );
+      receiver->value_.emplace( std::move( value ) );
+      woken = receiver;
+      return true;
+    }
+    if ( count_ == Capacity )
+      return false;
+    std::construct_at( ptr( ( head_ + count_ ) % Capacity ), std::move( value ) );
+    ++count_;
+    return true;
+  }
+
+  // Caller holds the lock. Moves the oldest value into value and refills the freed
+  // slot from the oldest waiting sender; returns false if the buffer is empty.
+  bool take( std::optional<T>& value, waiter*& woken ) noexcept
+  {
+    if ( count_ == 0 )
+      return false;
+    value.emplace( std::move( *ptr( head_ ) ) );
+    std::destroy_at( ptr( head_ ) );
+    head_ = ( head_ + 1 ) % Capacity;
+    --count_;
+    if ( !senders_.empty() )
+    {
+      auto sender = static_cast<send_awaiter*>( senders_.pop_front() );
+      std::construct_at( ptr( ( head_ + count_ ) % Capacity ), std::move( sender->value_ ) );
+      ++count_;
+      sender->sent_ = true;
+      woken = sender;
+    }
+    return true;
+  }
+
+  void wake( waiter* w )
+  {
+    if ( w == nullptr )
+      return;
+    // The waiter is already unlinked and its send or receive already done, so it
+    // must run somewhere; resume it here rather than strand it
+    if ( tryPost_ == nullptr || !tryPost_( executor_, w->handle ) )
+      w->handle.resume();
+  }
+
+  void wakeAll( waiterList& list )
+  {
+    while ( !list.empty() )
+      wake( list.pop_front() ); // unlinked before resuming, which may destroy the node
+  }
+
+private:
+
+  mutable lock_type lock_;
+  waiterList senders_;   // suspended while full
+  waiterList receivers_; // suspended while empty
+  size_t head_ = 0;
+  size_t count_ = 0;
+  bool closed_ = false;
+  void* executor_ = nullptr;
+  bool ( *tryPost_ )( void*, std::coroutine_handle<> ) = nullptr;
+  alignas( T ) std::byte data_[ sizeof( T ) * Capacity ];
+
+}; // class inplace_channel
+
+} // namespace PKIsensee
+
+#pragma warning(pop)
+
+///////////////////////////////////////////////////////////////////////////////
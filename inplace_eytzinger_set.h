@@ -0,0 +1,158 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  inplace_eytzinger_set.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  Static search table in Eytzinger (BFS) order
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <array>
+#include "inplace_algorithm.h"
+#include "inplace_vector.h"
+
+namespace PKIsensee
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Read-mostly search table built from a sorted inplace_vector. Keys are stored in
+// the breadth-first order of an implicit binary search tree: the children of slot
+// k (1-based) are slots 2k and 2k+1. The first levels of every search share a few
+// cache lines, and the 16 descendants four levels below a node are contiguous, so
+// each step prefetches the line needed four steps later. Descent is branchless.
+//
+// lower_bound() returns the same position lower_bound would return on the source
+// vector. Performs no memory allocations.
+
+template < typename Key, size_t Capacity, typename Compare = std::less<Key> >
+class inplace_eytzinger_set
+{
+public:
+
+  using key_type    = Key;
+  using key_compare = Compare;
+  using size_type   = size_t;
+  using index_type  = detail::IndexFor<Capacity>;
+
+  // Constructors -------------------------------------------------------------
+
+  inplace_eytzinger_set() = default;
+
+  explicit inplace_eytzinger_set( const inplace_vector<Key, Capacity>& sorted,
+                                  const Compare& comp = Compare() )
+    : comp_( comp )
+  {
+    assign( sorted );
+  }
+
+  // Rebuilds the table from sorted, which must be ordered by key_comp()
+  void assign( const inplace_vector<Key, Capacity>& sorted )
+  {
+    assert( std::is_sorted( sorted.begin(), sorted.end(), comp_ ) );
+    keys_.clear();
+    size_t rank = 0;
+    assignRanks( 1, sorted.size(), rank );
+    for ( size_t k = 0; k < sorted.size(); ++k )
+      keys_.unchecked_push_back( sorted[ ranks_[ k ] ] );
+  }
+
+  // Size and capacity --------------------------------------------------------
+
+  bool empty() const noexcept
+  {
+    return keys_.empty();
+  }
+
+  size_type size() const noexcept
+  {
+    return keys_.size();
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Capacity;
+  }
+
+  void clear() noexcept
+  {
+    keys_.clear();
+  }
+
+  // Lookup -------------------------------------------------------------------
+
+  size_type lower_bound( const Key& key ) const
+  {
+    // Position in the source vector of the first key not less than key, or size()
+    const auto k = lowerBoundSlot( key );
+    return ( k == 0 ) ? size() : ranks_[ k - 1 ];
+  }
+
+  bool contains( const Key& key ) const
+  {
+    const auto k = lowerBoundSlot( key );
+    return k != 0 && !comp_( key, keys_[ k - 1 ] );
+  }
+
+  // Observers ----------------------------------------------------------------
+
+  key_compare key_comp() const
+  {
+    return comp_;
+  }
+
+private:
+
+  // Slots of the 16 descendants four levels down start at slot 16k
+  static constexpr size_t kPrefetchStride = 16;
+
+  size_t lowerBoundSlot( const Key& key ) const
+  {
+    // Returns the 1-based slot of the lower bound, or 0 if every key is less than key
+    const auto keys = keys_.begin();
+    const auto count = size();
+    size_t k = 1;
+    while ( k <= count )
+    {
+      detail::prefetch( reinterpret_cast<const char*>( keys ) +
+                        ( k * kPrefetchStride - 1 ) * sizeof( Key ) );
+      k = 2 * k + ( comp_( keys[ k - 1 ], key ) ? 1 : 0 );
+    }
+    // The path ends with a run of right turns (1 bits) after the last left turn;
+    // the node where that left turn happened is the answer
+    return k >> ( std::countr_one( k ) + 1 );
+  }
+
+  void assignRanks( size_t k, size_t count, size_t& rank )
+  {
+    // In-order traversal of the implicit tree visits slots in sorted order
+    if ( k > count )
+      return;
+    assignRanks( 2 * k, count, rank );
+    ranks_[ k - 1 ] = static_cast<index_type>( rank++ );
+    assignRanks( 2 * k + 1, count, rank );
+  }
+
+private:
+
+  inplace_vector<Key, Capacity> keys_;        // BFS order; slot k at keys_[ k - 1 ]
+  std::array<index_type, Capacity> ranks_{};  // source position of each slot
+  [[no_unique_address]] Compare comp_;
+
+}; // class inplace_eytzinger_set
+
+} // namespace PKIsensee
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,863 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  inplace_flat_map.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  Sorted associative containers built on inplace_vector
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <utility>
+#include "inplace_algorithm.h"
+#include "inplace_vector.h"
+
+namespace PKIsensee
+{
+
+// Tag indicating that input is already sorted and free of duplicate keys
+struct sorted_unique_t
+{
+  explicit sorted_unique_t() = default;
+};
+inline constexpr sorted_unique_t sorted_unique{};
+
+namespace detail
+{
+  // Proxy iterator over parallel key and value arrays. Dereferencing yields a pair
+  // of references, so keys stay in their own cache-dense array.
+  template < typename Key, typename Value, bool IsConst >
+  class flatMapIterator
+  {
+  public:
+
+    using mapped_pointer    = std::conditional_t<IsConst, const Value*, Value*>;
+    using iterator_concept  = std::random_access_iterator_tag;
+    using iterator_category = std::input_iterator_tag;
+    using value_type        = std::pair<Key, Value>;
+    using difference_type   = ptrdiff_t;
+    using reference         = std::pair<const Key&, std::conditional_t<IsConst, const Value&, Value&>>;
+
+    struct pointer // arrow proxy; it->first and it->second
+    {
+      reference ref;
+      const reference* operator->() const noexcept
+      {
+        return std::addressof( ref );
+      }
+    };
+
+    constexpr flatMapIterator() noexcept = default;
+
+    constexpr flatMapIterator( const Key* key, mapped_pointer value ) noexcept
+      : key_( key ), value_( value )
+    {
+    }
+
+    constexpr operator flatMapIterator<Key, Value, true>() const noexcept
+      requires( !IsConst )
+    {
+      return { key_, value_ };
+    }
+
+    constexpr reference operator*() const noexcept
+    {
+      return { *key_, *value_ };
+    }
+
+    constexpr pointer operator->() const noexcept
+    {
+      return { **this };
+    }
+
+    constexpr reference operator[]( difference_type n ) const noexcept
+    {
+      return *( *this + n );
+    }
+
+    constexpr flatMapIterator& operator++() noexcept
+    {
+      ++key_;
+      ++value_;
+      return *this;
+    }
+
+    constexpr flatMapIterator operator++( int ) noexcept
+    {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    constexpr flatMapIterator& operator--() noexcept
+    {
+      --key_;
+      --value_;
+      return *this;
+    }
+
+    constexpr flatMapIterator operator--( int ) noexcept
+    {
+      auto tmp = *this;
+      --*this;
+      return tmp;
+    }
+
+    constexpr flatMapIterator& operator+=( difference_type n ) noexcept
+    {
+      key_ += n;
+      value_ += n;
+      return *this;
+    }
+
+    constexpr flatMapIterator& operator-=( difference_type n ) noexcept
+    {
+      return *this += -n;
+    }
+
+    friend constexpr flatMapIterator operator+( flatMapIterator it, difference_type n ) noexcept
+    {
+      return it += n;
+    }
+
+    friend constexpr flatMapIterator operator+( difference_type n, flatMapIterator it ) noexcept
+    {
+      return it += n;
+    }
+
+    friend constexpr flatMapIterator operator-( flatMapIterator it, difference_type n ) noexcept
+    {
+      return it -= n;
+    }
+
+    friend constexpr difference_type operator-( const flatMapIterator& lhs, const flatMapIterator& rhs ) noexcept
+    {
+      return lhs.key_ - rhs.key_;
+    }
+
+    friend constexpr bool operator==( const flatMapIterator& lhs, const flatMapIterator& rhs ) noexcept
+    {
+      return lhs.key_ == rhs.key_;
+    }
+
+    friend constexpr auto operator<=>( const flatMapIterator& lhs, const flatMapIterator& rhs ) noexcept
+    {
+      return lhs.key_ <=> rhs.key_;
+    }
+
+    constexpr const Key* key_ptr() const noexcept
+    {
+      return key_;
+    }
+
+  private:
+
+    const Key* key_ = nullptr;
+    mapped_pointer value_ = nullptr;
+
+  }; // class flatMapIterator
+
+  // Collects into incoming, sorted by key, the elements of rng whose keys are in
+  // neither incoming nor the container (per contains). incoming is compacted when it
+  // fills, so rng may be longer than Capacity if its new keys fit. Throws
+  // std::bad_alloc, without touching the container, once existing + new keys would
+  // exceed Capacity.
+  template < typename Element, size_t Capacity, typename Range, typename KeyOf, typename Compare,
+             typename Contains >
+  void collectNewKeys( inplace_vector<Element, Capacity>& incoming, Range&& rng, size_t existing,
+                       KeyOf keyOf, Compare& comp, Contains contains )
+  {
+    const auto byKey = [&]( const Element& lhs, const Element& rhs )
+    {
+      return comp( keyOf( lhs ), keyOf( rhs ) );
+    };
+    size_t sorted = 0; // incoming[ 0, sorted ) is sorted and unique
+    const auto isKnown = [&]( const Element& e )
+    {
+      const auto last = incoming.begin() + sorted;
+      const auto it = std::lower_bound( incoming.begin(), last, e, byKey );
+      return ( it != last && !byKey( e, *it ) ) || contains( keyOf( e ) );
+    };
+    const auto compact = [&]
+    {
+      sort_unique( incoming, byKey );
+      if ( incoming.size() > Capacity - existing )
+        throw std::bad_alloc();
+      sorted = incoming.size();
+    };
+
+    for ( auto&& element : rng )
+    {
+      if ( incoming.size() == Capacity )
+      {
+        compact();
+        if ( incoming.size() == Capacity ) // container is empty; only known keys still fit
+        {
+          if ( !isKnown( Element( std::forward<decltype( element )>( element ) ) ) )
+            throw std::bad_alloc();
+          continue;
+        }
+      }
+      incoming.unchecked_emplace_back( std::forward<decltype( element )>( element ) );
+      if ( isKnown( incoming.back() ) )
+        incoming.pop_back();
+    }
+    compact();
+  }
+
+}; // namespace detail
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Sorted set of at most Capacity unique keys in an inplace_vector.
+// Lookups use a branchless binary search. Performs no memory allocations;
+// inserting into a full set throws std::bad_alloc, as inplace_vector does.
+
+template < typename Key, size_t Capacity, typename Compare = std::less<Key> >
+class inplace_flat_set
+{
+public:
+
+  using key_type               = Key;
+  using value_type             = Key;
+  using key_compare            = Compare;
+  using value_compare          = Compare;
+  using container_type         = inplace_vector<Key, Capacity>;
+  using size_type              = size_t;
+  using difference_type        = ptrdiff_t;
+  using reference              = const Key&;
+  using const_reference        = const Key&;
+  using iterator               = const Key*;
+  using const_iterator         = const Key*;
+  using reverse_iterator       = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  // Constructors -------------------------------------------------------------
+
+  constexpr inplace_flat_set() = default;
+
+  constexpr explicit inplace_flat_set( const Compare& comp )
+    : comp_( comp )
+  {
+  }
+
+  // Bulk construction sorts once. The input may be longer than Capacity if its
+  // unique keys fit.
+  template <typename InIt>
+  inplace_flat_set( InIt first, InIt last, const Compare& comp = Compare() )
+    : comp_( comp )
+  {
+    insert_range( std::ranges::subrange( first, last ) );
+  }
+
+  inplace_flat_set( std::initializer_list<Key> iList, const Compare& comp = Compare() )
+    : inplace_flat_set( iList.begin(), iList.end(), comp )
+  {
+  }
+
+  template <typename Range>
+  inplace_flat_set( std::from_range_t, Range&& rng, const Compare& comp = Compare() )
+    : comp_( comp )
+  {
+    insert_range( std::forward<Range>( rng ) );
+  }
+
+  inplace_flat_set( sorted_unique_t, container_type keys, const Compare& comp = Compare() )
+    : keys_( std::move( keys ) ), comp_( comp )
+  {
+    assert( isSortedUnique() );
+  }
+
+  template <typename InIt>
+  inplace_flat_set( sorted_unique_t, InIt first, InIt last, const Compare& comp = Compare() )
+    : keys_( first, last ), comp_( comp )
+  {
+    assert( isSortedUnique() );
+  }
+
+  // Iterators ----------------------------------------------------------------
+
+  constexpr const_iterator begin() const noexcept
+  {
+    return keys_.begin();
+  }
+
+  constexpr const_iterator end() const noexcept
+  {
+    return keys_.end();
+  }
+
+  constexpr const_iterator cbegin() const noexcept
+  {
+    return keys_.begin();
+  }
+
+  constexpr const_iterator cend() const noexcept
+  {
+    return keys_.end();
+  }
+
+  constexpr const_reverse_iterator rbegin() const noexcept
+  {
+    return const_reverse_iterator( end() );
+  }
+
+  constexpr const_reverse_iterator rend() const noexcept
+  {
+    return const_reverse_iterator( begin() );
+  }
+
+  // Size and capacity --------------------------------------------------------
+
+  constexpr bool empty() const noexcept
+  {
+    return keys_.empty();
+  }
+
+  constexpr size_type size() const noexcept
+  {
+    return keys_.size();
+  }
+
+  static constexpr size_type max_size() noexcept
+  {
+    return Capacity;
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Capacity;
+  }
+
+  // Modifiers ----------------------------------------------------------------
+
+  std::pair<iterator, bool> insert( const Key& key )
+  {
+    return insertImpl( key );
+  }
+
+  std::pair<iterator, bool> insert( Key&& key )
+  {
+    return insertImpl( std::move( key ) );
+  }
+
+  template <typename... Types>
+  std::pair<iterator, bool> emplace( Types&&... values )
+  {
+    return insertImpl( Key( std::forward<Types>( values )... ) );
+  }
+
+  // Throws std::bad_alloc, leaving the set unchanged, if the new keys don't fit.
+  // rng itself may be longer than Capacity.
+  template <typename Range>
+  void insert_range( Range&& rng )
+  {
+    // Sorts the incoming keys once and merges them in a single pass instead of
+    // performing one shifting insert per key
+    container_type incoming;
+    detail::collectNewKeys( incoming, std::forward<Range>( rng ), size(), std::identity{}, comp_,
+                            [this]( const Key& key ) { return contains( key ); } );
+    container_type merged;
+    merge_into( keys_, incoming, merged, comp_ );
+    keys_ = std::move( merged );
+  }
+
+  iterator erase( const_iterator pos )
+  {
+    return keys_.erase( pos );
+  }
+
+  size_type erase( const Key& key )
+  {
+    const auto it = find( key );
+    if ( it == end() )
+      return 0;
+    keys_.erase( it );
+    return 1;
+  }
+
+  void clear() noexcept
+  {
+    keys_.clear();
+  }
+
+  container_type extract() &&
+  {
+    return std::move( keys_ );
+  }
+
+  // Lookup -------------------------------------------------------------------
+
+  const_iterator lower_bound( const Key& key ) const
+  {
+    return begin() + detail::branchlessLowerBound( keys_.begin(), size(), key, comp_ );
+  }
+
+  const_iterator upper_bound( const Key& key ) const
+  {
+    return std::upper_bound( begin(), end(), key, comp_ );
+  }
+
+  std::pair<const_iterator, const_iterator> equal_range( const Key& key ) const
+  {
+    const auto it = find( key );
+    return { it, ( it == end() ) ? it : it + 1 };
+  }
+
+  const_iterator find( const Key& key ) const
+  {
+    const auto it = lower_bound( key );
+    return ( it != end() && !comp_( key, *it ) ) ? it : end();
+  }
+
+  bool contains( const Key& key ) const
+  {
+    return find( key ) != end();
+  }
+
+  size_type count( const Key& key ) const
+  {
+    return contains( key ) ? 1 : 0;
+  }
+
+  // Observers ----------------------------------------------------------------
+
+  key_compare key_comp() const
+  {
+    return comp_;
+  }
+
+  const container_type& keys() const noexcept
+  {
+    return keys_;
+  }
+
+  // Non-member functions -----------------------------------------------------
+
+  friend bool operator==( const inplace_flat_set& lhs, const inplace_flat_set& rhs )
+  {
+    return lhs.keys_ == rhs.keys_;
+  }
+
+  friend auto operator<=>( const inplace_flat_set& lhs, const inplace_flat_set& rhs )
+  {
+    return lhs.keys_ <=> rhs.keys_;
+  }
+
+private:
+
+  template <typename K>
+  std::pair<iterator, bool> insertImpl( K&& key )
+  {
+    const auto i = detail::branchlessLowerBound( keys_.begin(), size(), key, comp_ );
+    if ( i < size() && !comp_( key, keys_[ i ] ) )
+      return { begin() + i, false };
+    keys_.insert( keys_.begin() + i, std::forward<K>( key ) );
+    return { begin() + i, true };
+  }
+
+  bool isSortedUnique() const
+  {
+    return std::adjacent_find( begin(), end(), [this]( const Key& lhs, const Key& rhs )
+      {
+        return !comp_( lhs, rhs );
+      } ) == end();
+  }
+
+private:
+
+  container_type keys_;
+  [[no_unique_address]] Compare comp_;
+
+}; // class inplace_flat_set
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Sorted map of at most Capacity unique keys. Keys and values live in separate
+// inplace_vectors so binary search touches only the dense key array. Iterators
+// dereference to std::pair<const Key&, Value&>. Performs no memory allocations;
+// inserting into a full map throws std::bad_alloc.
+
+template < typename Key, typename Value, size_t Capacity, typename Compare = std::less<Key> >
+class inplace_flat_map
+{
+public:
+
+  using key_type               = Key;
+  using mapped_type            = Value;
+  using value_type             = std::pair<Key, Value>;
+  using key_compare            = Compare;
+  using key_container_type     = inplace_vector<Key, Capacity>;
+  using mapped_container_type  = inplace_vector<Value, Capacity>;
+  using size_type              = size_t;
+  using difference_type        = ptrdiff_t;
+  using iterator               = detail::flatMapIterator<Key, Value, false>;
+  using const_iterator         = detail::flatMapIterator<Key, Value, true>;
+  using reference              = typename iterator::reference;
+  using const_reference        = typename const_iterator::reference;
+  using reverse_iterator       = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  // Constructors -------------------------------------------------------------
+
+  constexpr inplace_flat_map() = default;
+
+  constexpr explicit inplace_flat_map( const Compare& comp )
+    : comp_( comp )
+  {
+  }
+
+  // Bulk construction sorts once. The input may be longer than Capacity if its
+  // unique keys fit. Which of several elements with equivalent keys is kept is
+  // unspecified.
+  template <typename InIt>
+  inplace_flat_map( InIt first, InIt last, const Compare& comp = Compare() )
+    : comp_( comp )
+  {
+    insert_range( std::ranges::subrange( first, last ) );
+  }
+
+  inplace_flat_map( std::initializer_list<value_type> iList, const Compare& comp = Compare() )
+    : inplace_flat_map( iList.begin(), iList.end(), comp )
+  {
+  }
+
+  template <typename Range>
+  inplace_flat_map( std::from_range_t, Range&& rng, const Compare& comp = Compare() )
+    : comp_( comp )
+  {
+    insert_range( std::forward<Range>( rng ) );
+  }
+
+  inplace_flat_map( sorted_unique_t, key_container_type keys, mapped_container_type values,
+                    const Compare& comp = Compare() )
+    : keys_( std::move( keys ) ), values_( std::move( values ) ), comp_( comp )
+  {
+    assert( keys_.size() == values_.size() );
+    assert( std::adjacent_find( keys_.begin(), keys_.end(), [this]( const Key& lhs, const Key& rhs )
+      {
+        return !comp_( lhs, rhs );
+      } ) == keys_.end() );
+  }
+
+  // Iterators ----------------------------------------------------------------
+
+  iterator begin() noexcept
+  {
+    return makeIterator( 0 );
+  }
+
+  const_iterator begin() const noexcept
+  {
+    return makeIterator( 0 );
+  }
+
+  const_iterator cbegin() const noexcept
+  {
+    return begin();
+  }
+
+  iterator end() noexcept
+  {
+    return makeIterator( size() );
+  }
+
+  const_iterator end() const noexcept
+  {
+    return makeIterator( size() );
+  }
+
+  const_iterator cend() const noexcept
+  {
+    return end();
+  }
+
+  reverse_iterator rbegin() noexcept
+  {
+    return reverse_iterator( end() );
+  }
+
+  const_reverse_iterator rbegin() const noexcept
+  {
+    return const_reverse_iterator( end() );
+  }
+
+  reverse_iterator rend() noexcept
+  {
+    return reverse_iterator( begin() );
+  }
+
+  const_reverse_iterator rend() const noexcept
+  {
+    return const_reverse_iterator( begin() );
+  }
+
+  // Size and capacity --------------------------------------------------------
+
+  bool empty() const noexcept
+  {
+    return keys_.empty();
+  }
+
+  size_type size() const noexcept
+  {
+    return keys_.size();
+  }
+
+  static constexpr size_type max_size() noexcept
+  {
+    return Capacity;
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Capacity;
+  }
+
+  // Element access -----------------------------------------------------------
+
+  Value& operator[]( const Key& key )
+    requires( std::default_initializable<Value> )
+  {
+    return values_[ emplaceImpl( key ).first ];
+  }
+
+  Value& operator[]( Key&& key )
+    requires( std::default_initializable<Value> )
+  {
+    return values_[ emplaceImpl( std::move( key ) ).first ];
+  }
+
+  Value& at( const Key& key )
+  {
+    const auto i = findIndex( key );
+    if ( i == size() )
+      throw std::out_of_range( "inplace_flat_map::at" );
+    return values_[ i ];
+  }
+
+  const Value& at( const Key& key ) const
+  {
+    const auto i = findIndex( key );
+    if ( i == size() )
+      throw std::out_of_range( "inplace_flat_map::at" );
+    return values_[ i ];
+  }
+
+  // Modifiers ----------------------------------------------------------------
+
+  std::pair<iterator, bool> insert( const value_type& value )
+  {
+    return toIteratorPair( emplaceImpl( value.first, value.second ) );
+  }
+
+  std::pair<iterator, bool> insert( value_type&& value )
+  {
+    return toIteratorPair( emplaceImpl( std::move( value.first ), std::move( value.second ) ) );
+  }
+
+  template <typename... Types>
+  std::pair<iterator, bool> emplace( Types&&... values )
+  {
+    value_type value( std::forward<Types>( values )... );
+    return insert( std::move( value ) );
+  }
+
+  template <typename V>
+  std::pair<iterator, bool> insert_or_assign( const Key& key, V&& value )
+  {
+    const auto [ i, inserted ] = emplaceImpl( key, std::forward<V>( value ) );
+    if ( !inserted )
+      values_[ i ] = std::forward<V>( value );
+    return { makeIterator( i ), inserted };
+  }
+
+  // Throws std::bad_alloc, leaving the map unchanged, if the new keys don't fit.
+  // rng itself may be longer than Capacity.
+  template <typename Range>
+  void insert_range( Range&& rng )
+  {
+    // Sorts the incoming elements once and merges them in a single pass instead of
+    // performing one shifting insert per element. Existing keys keep their values.
+    inplace_vector<value_type, Capacity> incoming;
+    detail::collectNewKeys( incoming, std::forward<Range>( rng ), size(),
+                            []( const value_type& value ) -> const Key& { return value.first; }, comp_,
+                            [this]( const Key& key ) { return findIndex( key ) != size(); } );
+
+    // Every incoming key is new and the total fits, so the merge can't overflow
+    key_container_type mergedKeys;
+    mapped_container_type mergedValues;
+    size_t i = 0;
+    size_t j = 0;
+    while ( i < size() || j < incoming.size() )
+    {
+      if ( j == incoming.size() || ( i < size() && comp_( keys_[ i ], incoming[ j ].first ) ) )
+      {
+        mergedKeys.unchecked_emplace_back( std::move( keys_[ i ] ) );
+        mergedValues.unchecked_emplace_back( std::move( values_[ i ] ) );
+        ++i;
+      }
+      else
+      {
+        mergedKeys.unchecked_emplace_back( std::move( incoming[ j ].first ) );
+        mergedValues.unchecked_emplace_back( std::move( incoming[ j ].second ) );
+        ++j;
+      }
+    }
+    keys_ = std::move( mergedKeys );
+    values_ = std::move( mergedValues );
+  }
+
+  iterator erase( const_iterator pos )
+  {
+    const auto i = static_cast<size_type>( pos.key_ptr() - keys_.begin() );
+    keys_.erase( keys_.begin() + i );
+    values_.erase( values_.begin() + i );
+    return makeIterator( i );
+  }
+
+  size_type erase( const Key& key )
+  {
+    const auto i = findIndex( key );
+    if ( i == size() )
+      return 0;
+    erase( makeIterator( i ) );
+    return 1;
+  }
+
+  void clear() noexcept
+  {
+    keys_.clear();
+    values_.clear();
+  }
+
+  // Lookup -------------------------------------------------------------------
+
+  iterator find( const Key& key )
+  {
+    return makeIterator( findIndex( key ) );
+  }
+
+  const_iterator find( const Key& key ) const
+  {
+    return makeIterator( findIndex( key ) );
+  }
+
+  iterator lower_bound( const Key& key )
+  {
+    return makeIterator( lowerBoundIndex( key ) );
+  }
+
+  const_iterator lower_bound( const Key& key ) const
+  {
+    return makeIterator( lowerBoundIndex( key ) );
+  }
+
+  bool contains( const Key& key ) const
+  {
+    return findIndex( key ) != size();
+  }
+
+  size_type count( const Key& key ) const
+  {
+    return contains( key ) ? 1 : 0;
+  }
+
+  // Observers ----------------------------------------------------------------
+
+  key_compare key_comp() const
+  {
+    return comp_;
+  }
+
+  const key_container_type& keys() const noexcept
+  {
+    return keys_;
+  }
+
+  const mapped_container_type& values() const noexcept
+  {
+    return values_;
+  }
+
+  // Non-member functions -----------------------------------------------------
+
+  friend bool operator==( const inplace_flat_map& lhs, const inplace_flat_map& rhs )
+  {
+    return lhs.keys_ == rhs.keys_ && lhs.values_ == rhs.values_;
+  }
+
+private:
+
+  size_type lowerBoundIndex( const Key& key ) const
+  {
+    return detail::branchlessLowerBound( keys_.begin(), size(), key, comp_ );
+  }
+
+  size_type findIndex( const Key& key ) const
+  {
+    // Returns size() if key is not present
+    const auto i = lowerBoundIndex( key );
+    return ( i < size() && !comp_( key, keys_[ i ] ) ) ? i : size();
+  }
+
+  iterator makeIterator( size_type i ) noexcept
+  {
+    return { keys_.begin() + i, values_.begin() + i };
+  }
+
+  const_iterator makeIterator( size_type i ) const noexcept
+  {
+    return { keys_.begin() + i, values_.begin() + i };
+  }
+
+  std::pair<iterator, bool> toIteratorPair( std::pair<size_type, bool> result ) noexcept
+  {
+    return { makeIterator( result.first ), result.second };
+  }
+
+  // Inserts key with a value constructed from values if key is absent.
+  // Returns the index of the element with key and whether it was inserted.
+  template <typename K, typename... Types>
+  std::pair<size_type, bool> emplaceImpl( K&& key, Types&&... values )
+  {
+    const auto i = lowerBoundIndex( key );
+    if ( i < size() && !comp_( key, keys_[ i ] ) )
+      return { i, false };
+
+    // Both vectors have the same capacity, so only the first insert can overflow
+    keys_.emplace( keys_.begin() + i, std::forward<K>( key ) );
+    try
+    {
+      values_.emplace( values_.begin() + i, std::forward<Types>( values )... );
+    }
+    catch ( ... )
+    {
+      keys_.erase( keys_.begin() + i );
+      throw;
+    }
+    return { i, true };
+  }
+
+private:
+
+  key_container_type keys_;
+  mapped_container_type values_;
+  [[no_unique_address]] Compare comp_;
+
+}; // class inplace_flat_map
+
+} // namespace PKIsensee
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,403 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  inplace_linear_map.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  Unsorted small map with SIMD linear-scan lookup
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <initializer_list>
+#include <utility>
+#include "inplace_flat_map.h"
+#include "inplace_vector.h"
+
+namespace PKIsensee
+{
+
+namespace detail
+{
+  // Keys that can be found by comparing their bytes 16 at a time
+  template < typename T, typename KeyEqual >
+  constexpr bool isSimdFindable = isBitwiseComparable<T> &&
+    ( sizeof( T ) == 1 || sizeof( T ) == 2 || sizeof( T ) == 4 || sizeof( T ) == 8 ) &&
+    ( std::is_same_v<KeyEqual, std::equal_to<T>> || std::is_same_v<KeyEqual, std::equal_to<>> );
+
+#if PKISENSEE_SSE2
+  template < typename T >
+  __m128i splat( const T& value ) noexcept
+  {
+    if constexpr ( sizeof( T ) == 1 )
+      return _mm_set1_epi8( std::bit_cast<char>( value ) );
+    else if constexpr ( sizeof( T ) == 2 )
+      return _mm_set1_epi16( std::bit_cast<short>( value ) );
+    else if constexpr ( sizeof( T ) == 4 )
+      return _mm_set1_epi32( std::bit_cast<int>( value ) );
+    else
+      return _mm_set1_epi64x( std::bit_cast<long long>( value ) );
+  }
+
+  // Returns a byte mask with all sizeof( T ) bits set for each equal lane
+  template < typename T >
+  uint32_t equalMask( const T* keys, __m128i needle ) noexcept
+  {
+    const auto block = _mm_loadu_si128( reinterpret_cast<const __m128i*>( keys ) );
+    __m128i eq;
+    if constexpr ( sizeof( T ) == 1 )
+      eq = _mm_cmpeq_epi8( block, needle );
+    else if constexpr ( sizeof( T ) == 2 )
+      eq = _mm_cmpeq_epi16( block, needle );
+    else if constexpr ( sizeof( T ) == 4 )
+      eq = _mm_cmpeq_epi32( block, needle );
+    else
+    {
+      // SSE2 has no 64-bit compare; a lane matches when both of its halves match
+      eq = _mm_cmpeq_epi32( block, needle );
+      eq = _mm_and_si128( eq, _mm_shuffle_epi32( eq, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+    }
+    return static_cast<uint32_t>( _mm_movemask_epi8( eq ) );
+  }
+#endif
+
+  // Returns the index of the first key equal to key, or count
+  template < typename T, typename KeyEqual >
+  size_t linearFind( const T* keys, size_t count, const T& key, const KeyEqual& equal )
+  {
+    size_t i = 0;
+#if PKISENSEE_SSE2
+    if constexpr ( isSimdFindable<T, KeyEqual> )
+    {
+      // Two blocks per iteration: 32 one-byte keys down to 4 eight-byte keys
+      constexpr size_t kLanes = 16 / sizeof( T );
+      const auto needle = splat( key );
+      for ( ; i + 2 * kLanes <= count; i += 2 * kLanes )
+      {
+        const auto mask = equalMask( keys + i, needle ) | ( equalMask( keys + i + kLanes, needle ) << 16 );
+        if ( mask != 0 )
+          return i + static_cast<size_t>( std::countr_zero( mask ) ) / sizeof( T );
+      }
+      if ( i + kLanes <= count )
+      {
+        const auto mask = equalMask( keys + i, needle );
+        if ( mask != 0 )
+          return i + static_cast<size_t>( std::countr_zero( mask ) ) / sizeof( T );
+        i += kLanes;
+      }
+    }
+#endif
+    for ( ; i < count; ++i )
+    {
+      if ( equal( keys[ i ], key ) )
+        return i;
+    }
+    return count;
+  }
+
+}; // namespace detail
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Unsorted map of at most Capacity unique keys, intended for Capacity <= 64. Keys
+// and values live in separate inplace_vectors; lookup scans the key array, comparing
+// up to 32 keys per step with SSE2 for integral, enum and pointer keys. Insert
+// appends and erase swaps the last element into the hole, so element order is
+// unspecified and erase invalidates iterators to the last element.
+//
+// Iterators dereference to std::pair<const Key&, Value&>. Performs no memory
+// allocations; inserting into a full map throws std::bad_alloc.
+
+template < typename Key, typename Value, size_t Capacity, typename KeyEqual = std::equal_to<Key> >
+class inplace_linear_map
+{
+public:
+
+  using key_type              = Key;
+  using mapped_type           = Value;
+  using value_type            = std::pair<Key, Value>;
+  using key_equal             = KeyEqual;
+  using key_container_type    = inplace_vector<Key, Capacity>;
+  using mapped_container_type = inplace_vector<Value, Capacity>;
+  using size_type             = size_t;
+  using difference_type       = ptrdiff_t;
+  using iterator              = detail::flatMapIterator<Key, Value, false>;
+  using const_iterator        = detail::flatMapIterator<Key, Value, true>;
+  using reference             = typename iterator::reference;
+  using const_reference       = typename const_iterator::reference;
+
+  // Constructors -------------------------------------------------------------
+
+  constexpr inplace_linear_map() = default;
+
+  constexpr explicit inplace_linear_map( const KeyEqual& equal )
+    : equal_( equal )
+  {
+  }
+
+  inplace_linear_map( std::initializer_list<value_type> iList, const KeyEqual& equal = KeyEqual() )
+    : equal_( equal )
+  {
+    for ( const auto& e : iList )
+      insert( e );
+  }
+
+  // Iterators ----------------------------------------------------------------
+
+  iterator begin() noexcept
+  {
+    return makeIterator( 0 );
+  }
+
+  const_iterator begin() const noexcept
+  {
+    return makeIterator( 0 );
+  }
+
+  const_iterator cbegin() const noexcept
+  {
+    return begin();
+  }
+
+  iterator end() noexcept
+  {
+    return makeIterator( size() );
+  }
+
+  const_iterator end() const noexcept
+  {
+    return makeIterator( size() );
+  }
+
+  const_iterator cend() const noexcept
+  {
+    return end();
+  }
+
+  // Size and capacity --------------------------------------------------------
+
+  bool empty() const noexcept
+  {
+    return keys_.empty();
+  }
+
+  size_type size() const noexcept
+  {
+    return keys_.size();
+  }
+
+  static constexpr size_type max_size() noexcept
+  {
+    return Capacity;
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Capacity;
+  }
+
+  // Element access -----------------------------------------------------------
+
+  Value& operator[]( const Key& key )
+    requires( std::default_initializable<Value> )
+  {
+    return values_[ emplaceImpl( key ).first ];
+  }
+
+  Value& at( const Key& key )
+  {
+    const auto i = findIndex( key );
+    if ( i == size() )
+      throw std::out_of_range( "inplace_linear_map::at" );
+    return values_[ i ];
+  }
+
+  const Value& at( const Key& key ) const
+  {
+    const auto i = findIndex( key );
+    if ( i == size() )
+      throw std::out_of_range( "inplace_linear_map::at" );
+    return values_[ i ];
+  }
+
+  // Modifiers ----------------------------------------------------------------
+
+  std::pair<iterator, bool> insert( const value_type& value )
+  {
+    return toIteratorPair( emplaceImpl( value.first, value.second ) );
+  }
+
+  std::pair<iterator, bool> insert( value_type&& value )
+  {
+    return toIteratorPair( emplaceImpl( std::move( value.first ), std::move( value.second ) ) );
+  }
+
+  template <typename... Types>
+  std::pair<iterator, bool> emplace( Types&&... values )
+  {
+    value_type value( std::forward<Types>( values )... );
+    return insert( std::move( value ) );
+  }
+
+  template <typename V>
+  std::pair<iterator, bool> insert_or_assign( const Key& key, V&& value )
+  {
+    const auto [ i, inserted ] = emplaceImpl( key, std::forward<V>( value ) );
+    if ( !inserted )
+      values_[ i ] = std::forward<V>( value );
+    return { makeIterator( i ), inserted };
+  }
+
+  iterator erase( const_iterator pos )
+  {
+    // Moves the last element into the hole; the returned iterator refers to it
+    const auto i = static_cast<size_type>( pos.key_ptr() - keys_.begin() );
+    assert( i < size() );
+    const auto last = size() - 1;
+    if ( i != last )
+    {
+      keys_[ i ] = std::move( keys_[ last ] );
+      values_[ i ] = std::move( values_[ last ] );
+    }
+    keys_.pop_back();
+    values_.pop_back();
+    return makeIterator( i );
+  }
+
+  size_type erase( const Key& key )
+  {
+    const auto i = findIndex( key );
+    if ( i == size() )
+      return 0;
+    erase( makeIterator( i ) );
+    return 1;
+  }
+
+  void clear() noexcept
+  {
+    keys_.clear();
+    values_.clear();
+  }
+
+  // Lookup -------------------------------------------------------------------
+
+  iterator find( const Key& key )
+  {
+    return makeIterator( findIndex( key ) );
+  }
+
+  const_iterator find( const Key& key ) const
+  {
+    return makeIterator( findIndex( key ) );
+  }
+
+  bool contains( const Key& key ) const
+  {
+    return findIndex( key ) != size();
+  }
+
+  size_type count( const Key& key ) const
+  {
+    return contains( key ) ? 1 : 0;
+  }
+
+  // Observers ----------------------------------------------------------------
+
+  key_equal key_eq() const
+  {
+    return equal_;
+  }
+
+  const key_container_type& keys() const noexcept
+  {
+    return keys_;
+  }
+
+  const mapped_container_type& values() const noexcept
+  {
+    return values_;
+  }
+
+  // Non-member functions -----------------------------------------------------
+
+  friend bool operator==( const inplace_linear_map& lhs, const inplace_linear_map& rhs )
+  {
+    // Order is unspecified, so match each element by key
+    if ( lhs.size() != rhs.size() )
+      return false;
+    for ( size_type i = 0; i < lhs.size(); ++i )
+    {
+      const auto j = rhs.findIndex( lhs.keys_[ i ] );
+      if ( j == rhs.size() || !( lhs.values_[ i ] == rhs.values_[ j ] ) )
+        return false;
+    }
+    return true;
+  }
+
+private:
+
+  size_type findIndex( const Key& key ) const
+  {
+    // Returns size() if key is not present
+    return detail::linearFind( keys_.begin(), size(), key, equal_ );
+  }
+
+  iterator makeIterator( size_type i ) noexcept
+  {
+    return { keys_.begin() + i, values_.begin() + i };
+  }
+
+  const_iterator makeIterator( size_type i ) const noexcept
+  {
+    return { keys_.begin() + i, values_.begin() + i };
+  }
+
+  std::pair<iterator, bool> toIteratorPair( std::pair<size_type, bool> result ) noexcept
+  {
+    return { makeIterator( result.first ), result.second };
+  }
+
+  // Appends key with a value constructed from values if key is absent.
+  // Returns the index of the element with key and whether it was inserted.
+  template <typename K, typename... Types>
+  std::pair<size_type, bool> emplaceImpl( K&& key, Types&&... values )
+  {
+    const auto i = findIndex( key );
+    if ( i != size() )
+      return { i, false };
+
+    // Both vectors have the same capacity, so only the first append can overflow
+    keys_.emplace_back( std::forward<K>( key ) );
+    try
+    {
+      values_.unchecked_emplace_back( std::forward<Types>( values )... );
+    }
+    catch ( ... )
+    {
+      keys_.pop_back();
+      throw;
+    }
+    return { i, true };
+  }
+
+private:
+
+  key_container_type keys_;
+  mapped_container_type values_;
+  [[no_unique_address]] KeyEqual equal_;
+
+}; // class inplace_linear_map
+
+} // namespace PKIsensee
+
+///////////////////////////////////////////////////////////////////////////////
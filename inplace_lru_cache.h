@@ -0,0 +1,321 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  inplace_lru_cache.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  Fixed-capacity least-recently-used cache
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <array>
+#include <utility>
+#include "inplace_vector.h"
+
+namespace PKIsensee
+{
+
+namespace detail
+{
+  // Default eviction callback
+  struct ignoreEviction
+  {
+    template < typename Key, typename Value >
+    constexpr void operator()( Key&, Value& ) const noexcept
+    {
+    }
+  };
+
+}; // namespace detail
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Least-recently-used cache of at most Capacity entries. Entries live in an
+// inplace_vector slab and form a doubly linked recency list through 16-bit
+// prev/next indices. An inline linear-probing table of entry indices, at most
+// half full, finds keys; erase uses backward-shift deletion so there are no
+// tombstones. get, put, erase and eviction are O(1) and never allocate.
+//
+// When put() needs room, the least recently used entry is passed to the OnEvict
+// callback as ( Key&, Value& ) and then destroyed; the callback may move from
+// either. get() maintains hit and miss counters; peek() and contains() do not
+// touch recency or counters.
+
+template < typename Key, typename Value, size_t Capacity, typename Hash = std::hash<Key>,
+           typename KeyEqual = std::equal_to<Key>, typename OnEvict = detail::ignoreEviction >
+class inplace_lru_cache
+{
+  using index_type = uint16_t;
+
+  static constexpr index_type kNil = 0xFFFF;
+  static constexpr size_t kBucketCount = std::max( size_t( 16 ), std::bit_ceil( Capacity * 2 ) );
+  static constexpr size_t kBucketMask = kBucketCount - 1;
+
+  static_assert( Capacity > 0 && Capacity < kNil, "inplace_lru_cache indices are 16 bits" );
+
+public:
+
+  using key_type    = Key;
+  using mapped_type = Value;
+  using hasher      = Hash;
+  using key_equal   = KeyEqual;
+  using size_type   = size_t;
+
+  // Constructors -------------------------------------------------------------
+
+  inplace_lru_cache()
+  {
+    buckets_.fill( kNil );
+  }
+
+  explicit inplace_lru_cache( const OnEvict& onEvict )
+    : onEvict_( onEvict )
+  {
+    buckets_.fill( kNil );
+  }
+
+  // Size and capacity --------------------------------------------------------
+
+  bool empty() const noexcept
+  {
+    return entries_.empty();
+  }
+
+  size_type size() const noexcept
+  {
+    return entries_.size();
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Capacity;
+  }
+
+  // Lookup -------------------------------------------------------------------
+
+  // Returns the cached value and marks it most recently used, or nullptr on a miss
+  Value* get( const Key& key )
+  {
+    const auto i = buckets_[ findBucket( key, hashOf( key ) ) ];
+    if ( i == kNil )
+    {
+      ++misses_;
+      return nullptr;
+    }
+    ++hits_;
+    touch( i );
+    return &entries_[ i ].value;
+  }
+
+  // Returns the cached value without changing recency or counters, or nullptr
+  const Value* peek( const Key& key ) const
+  {
+    const auto i = buckets_[ findBucket( key, hashOf( key ) ) ];
+    return ( i == kNil ) ? nullptr : &entries_[ i ].value;
+  }
+
+  bool contains( const Key& key ) const
+  {
+    return peek( key ) != nullptr;
+  }
+
+  // Modifiers ----------------------------------------------------------------
+
+  // Inserts or assigns the value for key and marks it most recently used. Evicts
+  // the least recently used entry if the cache is full.
+  template <typename V>
+  Value& put( const Key& key, V&& value )
+  {
+    const auto hash = hashOf( key );
+    auto bucket = findBucket( key, hash );
+    if ( buckets_[ bucket ] != kNil )
+    {
+      const auto i = buckets_[ bucket ];
+      entries_[ i ].value = std::forward<V>( value );
+      touch( i );
+      return entries_[ i ].value;
+    }
+
+    if ( entries_.size() == Capacity )
+    {
+      evict();
+      bucket = findBucket( key, hash ); // eviction may shift buckets
+    }
+    entries_.unchecked_emplace_back( key, std::forward<V>( value ), hash );
+    const auto i = static_cast<index_type>( entries_.size() - 1 );
+    buckets_[ bucket ] = i;
+    pushFront( i );
+    return entries_[ i ].value;
+  }
+
+  // Evicts the least recently used entry. Returns false if the cache is empty.
+  bool evict()
+  {
+    if ( tail_ == kNil )
+      return false;
+    auto& victim = entries_[ tail_ ];
+    onEvict_( victim.key, victim.value );
+    removeEntry( tail_ );
+    return true;
+  }
+
+  size_type erase( const Key& key )
+  {
+    // Erased entries are not passed to the eviction callback
+    const auto i = buckets_[ findBucket( key, hashOf( key ) ) ];
+    if ( i == kNil )
+      return 0;
+    removeEntry( i );
+    return 1;
+  }
+
+  void clear() noexcept
+  {
+    entries_.clear();
+    buckets_.fill( kNil );
+    head_ = kNil;
+    tail_ = kNil;
+  }
+
+  // Statistics ---------------------------------------------------------------
+
+  uint64_t hits() const noexcept
+  {
+    return hits_;
+  }
+
+  uint64_t misses() const noexcept
+  {
+    return misses_;
+  }
+
+  void reset_stats() noexcept
+  {
+    hits_ = 0;
+    misses_ = 0;
+  }
+
+private:
+
+  struct Entry
+  {
+    Key key;
+    Value value;
+    size_t hash;
+    index_type prev = kNil; // toward most recently used
+    index_type next = kNil; // toward least recently used
+  };
+
+  size_t hashOf( const Key& key ) const
+  {
+    return detail::toSizeHash( detail::mixHash( static_cast<uint64_t>( hash_( key ) ) ) );
+  }
+
+  size_t findBucket( const Key& key, size_t hash ) const
+  {
+    // Returns the bucket holding key, or the empty bucket where key belongs
+    for ( auto b = hash & kBucketMask; ; b = ( b + 1 ) & kBucketMask )
+    {
+      const auto i = buckets_[ b ];
+      if ( i == kNil || ( entries_[ i ].hash == hash && equal_( entries_[ i ].key, key ) ) )
+        return b;
+    }
+  }
+
+  size_t bucketOf( index_type i ) const noexcept
+  {
+    // Bucket holding entry i; compares indices only, so the key may be moved-from
+    auto b = entries_[ i ].hash & kBucketMask;
+    while ( buckets_[ b ] != i )
+      b = ( b + 1 ) & kBucketMask;
+    return b;
+  }
+
+  void removeBucket( size_t hole ) noexcept
+  {
+    // Backward-shift deletion: pull later members of the probe run into the hole
+    // when the hole lies between their home bucket and their current bucket
+    for ( auto b = ( hole + 1 ) & kBucketMask; buckets_[ b ] != kNil; b = ( b + 1 ) & kBucketMask )
+    {
+      const auto home = entries_[ buckets_[ b ] ].hash & kBucketMask;
+      if ( ( ( b - home ) & kBucketMask ) >= ( ( b - hole ) & kBucketMask ) )
+      {
+        buckets_[ hole ] = buckets_[ b ];
+        hole = b;
+      }
+    }
+    buckets_[ hole ] = kNil;
+  }
+
+  void removeEntry( index_type i )
+  {
+    // Swap-and-pop keeps the slab dense; the moved entry's links and bucket follow it
+    removeBucket( bucketOf( i ) );
+    unlink( i );
+    const auto last = static_cast<index_type>( entries_.size() - 1 );
+    if ( i != last )
+    {
+      buckets_[ bucketOf( last ) ] = i;
+      entries_[ i ] = std::move( entries_[ last ] );
+      const auto& moved = entries_[ i ];
+      ( moved.prev != kNil ? entries_[ moved.prev ].next : head_ ) = i;
+      ( moved.next != kNil ? entries_[ moved.next ].prev : tail_ ) = i;
+    }
+    entries_.pop_back();
+  }
+
+  void unlink( index_type i ) noexcept
+  {
+    auto& e = entries_[ i ];
+    ( e.prev != kNil ? entries_[ e.prev ].next : head_ ) = e.next;
+    ( e.next != kNil ? entries_[ e.next ].prev : tail_ ) = e.prev;
+    e.prev = kNil;
+    e.next = kNil;
+  }
+
+  void pushFront( index_type i ) noexcept
+  {
+    auto& e = entries_[ i ];
+    e.prev = kNil;
+    e.next = head_;
+    ( head_ != kNil ? entries_[ head_ ].prev : tail_ ) = i;
+    head_ = i;
+  }
+
+  void touch( index_type i ) noexcept
+  {
+    if ( i != head_ )
+    {
+      unlink( i );
+      pushFront( i );
+    }
+  }
+
+private:
+
+  inplace_vector<Entry, Capacity> entries_;
+  std::array<index_type, kBucketCount> buckets_; // entry index or kNil
+  index_type head_ = kNil; // most recently used
+  index_type tail_ = kNil; // least recently used
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  [[no_unique_address]] Hash hash_;
+  [[no_unique_address]] KeyEqual equal_;
+  [[no_unique_address]] OnEvict onEvict_;
+
+}; // class inplace_lru_cache
+
+} // namespace PKIsensee
+
+///////////////////////////////////////////////////////////////////////////////
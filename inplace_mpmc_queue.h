@@ -0,0 +1,322 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  inplace_mpmc_queue.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  Bounded multi-producer multi-consumer queue
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <memory>
+#include <span>
+#include "inplace_vector.h"
+
+#pragma warning(push)
+#pragma warning(disable: 26495) // "data_ is uninitialized", by design
+#pragma warning(disable: 4324)  // "structure was padded due to alignment specifier", by design
+
+namespace PKIsensee
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Bounded FIFO for any number of producer and consumer threads. Each slot holds
+// uninitialized storage for one T and a sequence number. Position p may be written
+// when its slot's sequence equals p, and read when it equals p + 1. The reader then
+// sets it to p + Capacity, handing the slot to the writer one lap later. Producers
+// and consumers claim positions with a CAS on their own counter. They touch only
+// the slots they claim, so a push and a pop contend only when the queue is nearly
+// empty or nearly full. Nothing allocates.
+//
+// try_push_n() and try_pop_n() claim a run of consecutive ready slots with one CAS.
+// wait_push() and wait_pop() block through std::atomic::wait while the queue is full
+// or empty. Notification costs one extra load per operation while nobody waits.
+//
+// T must be nothrow move constructible and assignable. A slot claimed but never
+// filled would stall every consumer behind it, so values whose construction may
+// throw are built before a slot is claimed.
+
+template < typename T, size_t Capacity >
+class inplace_mpmc_queue
+{
+  static_assert( Capacity > 0, "inplace_mpmc_queue requires Capacity > 0" );
+  static_assert( std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>,
+                 "inplace_mpmc_queue requires nothrow move" );
+
+  struct slot
+  {
+    std::atomic<size_t> seq;
+    alignas( T ) std::byte data[ sizeof( T ) ];
+
+    T* ptr() noexcept
+    {
+      return reinterpret_cast<T*>( data ); // safe on aligned std::byte array of T
+    }
+  };
+
+public:
+
+  using value_type = T;
+  using size_type  = size_t;
+
+  // Constructors -------------------------------------------------------------
+
+  inplace_mpmc_queue() noexcept
+  {
+    for ( size_t i = 0; i < Capacity; ++i )
+      slots_[ i ].seq.store( i, std::memory_order_relaxed );
+  }
+
+  inplace_mpmc_queue( const inplace_mpmc_queue& ) = delete;
+  inplace_mpmc_queue& operator=( const inplace_mpmc_queue& ) = delete;
+
+  ~inplace_mpmc_queue()
+  {
+    if constexpr ( !std::is_trivially_destructible_v<T> )
+    {
+      const auto tail = enqueuePos_.load( std::memory_order_acquire );
+      for ( auto pos = dequeuePos_.load( std::memory_order_relaxed ); pos != tail; ++pos )
+        std::destroy_at( slotAt( pos ).ptr() );
+    }
+  }
+
+  // Producers ----------------------------------------------------------------
+
+  // Returns false if the queue is full
+  template <typename... Types>
+  bool try_emplace( Types&&... values )
+  {
+    if constexpr ( std::is_nothrow_constructible_v<T, Types...> )
+    {
+      auto pos = enqueuePos_.load( std::memory_order_relaxed );
+      if ( claim<true>( enqueuePos_, pos, 1 ) == 0 )
+        return false;
+      auto& s = slotAt( pos );
+      std::construct_at( s.ptr(), std::forward<Types>( values )... );
+      publish( s, pos + 1 );
+      return true;
+    }
+    else
+    {
+      T value( std::forward<Types>( values )... );
+      return try_emplace( std::move( value ) );
+    }
+  }
+
+  bool try_push( const T& value )
+  {
+    return try_emplace( value );
+  }
+
+  bool try_push( T&& value )
+  {
+    return try_emplace( std::move( value ) );
+  }
+
+  // Copies the longest prefix of values that fits; returns the number pushed
+  size_type try_push_n( std::span<const T> values )
+  {
+    if constexpr ( std::is_nothrow_copy_constructible_v<T> )
+    {
+      auto pos = enqueuePos_.load( std::memory_order_relaxed );
+      const auto count = claim<true>( enqueuePos_, pos, values.size() );
+      for ( size_t i = 0; i < count; ++i )
+        std::construct_at( slotAt( pos + i ).ptr(), values[ i ] );
+      publishRun( pos, count, 1 );
+      return count;
+    }
+    else
+    {
+      size_type count = 0;
+      while ( count < values.size() && try_emplace( values[ count ] ) )
+        ++count;
+      return count;
+    }
+  }
+
+  // Blocks while the queue is full
+  template <typename... Types>
+  void wait_emplace( Types&&... values )
+  {
+    if constexpr ( std::is_nothrow_constructible_v<T, Types...> )
+    {
+      while ( !try_emplace( std::forward<Types>( values )... ) ) // forwarded only on success
+        waitWhile<true>();
+    }
+    else
+    {
+      T value( std::forward<Types>( values )... );
+      while ( !try_emplace( std::move( value ) ) )
+        waitWhile<true>();
+    }
+  }
+
+  void wait_push( const T& value )
+  {
+    wait_emplace( value );
+  }
+
+  void wait_push( T&& value )
+  {
+    wait_emplace( std::move( value ) );
+  }
+
+  // Consumers ----------------------------------------------------------------
+
+  // Moves the oldest element into value; returns false if the queue is empty
+  bool try_pop( T& value ) noexcept
+  {
+    auto pos = dequeuePos_.load( std::memory_order_relaxed );
+    if ( claim<false>( dequeuePos_, pos, 1 ) == 0 )
+      return false;
+    auto& s = slotAt( pos );
+    value = std::move( *s.ptr() );
+    std::destroy_at( s.ptr() );
+    publish( s, pos + Capacity );
+    return true;
+  }
+
+  // Moves up to out.size() elements into out; returns the number popped
+  size_type try_pop_n( std::span<T> out ) noexcept
+  {
+    auto pos = dequeuePos_.load( std::memory_order_relaxed );
+    const auto count = claim<false>( dequeuePos_, pos, out.size() );
+    for ( size_t i = 0; i < count; ++i )
+    {
+      const auto p = slotAt( pos + i ).ptr();
+      out[ i ] = std::move( *p );
+      std::destroy_at( p );
+    }
+    publishRun( pos, count, Capacity );
+    return count;
+  }
+
+  // Blocks while the queue is empty
+  void wait_pop( T& value ) noexcept
+  {
+    while ( !try_pop( value ) )
+      waitWhile<false>();
+  }
+
+  // Observers ----------------------------------------------------------------
+
+  // Exact only when no operation is in flight
+  size_type size_approx() const noexcept
+  {
+    const auto head = dequeuePos_.load( std::memory_order_acquire );
+    const auto tail = enqueuePos_.load( std::memory_order_acquire );
+    return ( tail > head ) ? std::min( tail - head, Capacity ) : 0;
+  }
+
+  bool empty_approx() const noexcept
+  {
+    return size_approx() == 0;
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Capacity;
+  }
+
+private:
+
+  slot& slotAt( size_t pos ) noexcept
+  {
+    return slots_[ pos % Capacity ];
+  }
+
+  // Claims up to count consecutive positions starting at pos that are ready for a
+  // producer (seq == pos) or a consumer (seq == pos + 1). Updates pos to the first
+  // claimed position and returns the number claimed, 0 if full or empty. A ready
+  // slot's sequence can change only after its position is claimed, so slots checked
+  // before a successful CAS are still ready after it.
+  template < bool Producer >
+  size_t claim( std::atomic<size_t>& counter, size_t& pos, size_t count ) noexcept
+  {
+    constexpr size_t kReady = Producer ? 0 : 1;
+    for ( ;; )
+    {
+      size_t n = 0;
+      while ( n < count && slotAt( pos + n ).seq.load( std::memory_order_acquire ) == pos + n + kReady )
+        ++n;
+      if ( n == 0 )
+      {
+        const auto seq = slotAt( pos ).seq.load( std::memory_order_acquire );
+        if ( static_cast<ptrdiff_t>( seq - ( pos + kReady ) ) < 0 )
+          return 0; // a lap behind: full for producers, empty for consumers
+        pos = counter.load( std::memory_order_relaxed );
+      }
+      else if ( counter.compare_exchange_weak( pos, pos + n, std::memory_order_relaxed ) )
+      {
+        return n;
+      }
+    }
+  }
+
+  void publish( slot& s, size_t seq ) noexcept
+  {
+    s.seq.store( seq, std::memory_order_release );
+    std::atomic_thread_fence( std::memory_order_seq_cst ); // orders the store before the waiters_ load
+    if ( waiters_.load( std::memory_order_relaxed ) != 0 )
+      s.seq.notify_all();
+  }
+
+  void publishRun( size_t pos, size_t count, size_t offset ) noexcept
+  {
+    if ( count == 0 )
+      return;
+    for ( size_t i = 0; i < count; ++i )
+      slotAt( pos + i ).seq.store( pos + i + offset, std::memory_order_release );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if ( waiters_.load( std::memory_order_relaxed ) != 0 )
+    {
+      for ( size_t i = 0; i < count; ++i )
+        slotAt( pos + i ).seq.notify_all();
+    }
+  }
+
+  // Sleeps until the slot at the producer or consumer position changes, unless it
+  // is already ready. Registering in waiters_ before the recheck pairs with the
+  // fence in publish(), so a wakeup can't be lost.
+  template < bool Producer >
+  void waitWhile() noexcept
+  {
+    constexpr size_t kReady = Producer ? 0 : 1;
+    waiters_.fetch_add( 1, std::memory_order_seq_cst );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    const auto pos = ( Producer ? enqueuePos_ : dequeuePos_ ).load( std::memory_order_relaxed );
+    auto& s = slotAt( pos );
+    const auto seq = s.seq.load( std::memory_order_acquire );
+    if ( static_cast<ptrdiff_t>( seq - ( pos + kReady ) ) < 0 )
+      s.seq.wait( seq, std::memory_order_acquire );
+    waiters_.fetch_sub( 1, std::memory_order_relaxed );
+  }
+
+private:
+
+  alignas( detail::kCacheLineSize ) std::atomic<size_t> enqueuePos_ = 0;
+  alignas( detail::kCacheLineSize ) std::atomic<size_t> dequeuePos_ = 0;
+  alignas( detail::kCacheLineSize ) std::atomic<uint32_t> waiters_ = 0; // threads blocked in wait_*
+  alignas( detail::kCacheLineSize ) std::array<slot, Capacity> slots_;
+
+}; // class inplace_mpmc_queue
+
+} // namespace PKIsensee
+
+#pragma warning(pop)
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,361 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  inplace_object_pool.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  Fixed-capacity object pool with O(1) acquire and release
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <mutex>
+#include "inplace_algorithm.h"
+#include "inplace_vector.h"
+
+#pragma warning(push)
+#pragma warning(disable: 26495) // "data_ is uninitialized", by design
+
+namespace PKIsensee
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Pool of at most Capacity objects T constructed in place in an aligned std::byte
+// array, the storage scheme inplace_vector uses. Each free slot holds the index of
+// the next free slot in its own bytes, so the free list costs no extra memory;
+// never-used slots are handed out in order, so construction is O(1) too. An
+// occupancy bitmap supports for_each() over live objects.
+//
+// acquire() throws std::bad_alloc when the pool is exhausted; try_acquire()
+// returns nullptr. Pointers remain valid until released, so the pool can't be
+// copied or moved. Live objects are destroyed with the pool.
+//
+// With ThreadSafe, the free list is guarded by a spin lock and any thread may
+// acquire and release. A local_cache keeps a few free slots per thread and moves
+// them to and from the pool in batches, so most operations take no lock. Slots
+// parked in a cache are unavailable to other threads until it flushes.
+// for_each() and size() must not race with acquire or release.
+
+template < typename T, size_t Capacity, bool ThreadSafe = false >
+class inplace_object_pool
+{
+  using index_type = detail::IndexFor<Capacity>;
+  using word_type  = std::conditional_t<ThreadSafe, std::atomic<uint64_t>, uint64_t>;
+  using lock_type  = std::conditional_t<ThreadSafe, detail::spinLock, detail::nullLock>;
+
+  static constexpr index_type kNil = static_cast<index_type>( Capacity );
+  static constexpr size_t kSlotAlign = std::max( alignof( T ), alignof( index_type ) );
+  static constexpr size_t kSlotSize = ( std::max( sizeof( T ), sizeof( index_type ) ) + kSlotAlign - 1 ) /
+                                      kSlotAlign * kSlotAlign;
+  static constexpr size_t kWordCount = ( Capacity + 63 ) / 64;
+
+public:
+
+  using value_type = T;
+  using size_type  = size_t;
+
+  // Constructors -------------------------------------------------------------
+
+  inplace_object_pool() = default;
+
+  inplace_object_pool( const inplace_object_pool& ) = delete;
+  inplace_object_pool& operator=( const inplace_object_pool& ) = delete;
+
+  ~inplace_object_pool()
+  {
+    if constexpr ( !std::is_trivially_destructible_v<T> )
+      for_each( []( T& obj ) { std::destroy_at( std::addressof( obj ) ); } );
+  }
+
+  // Acquire and release ------------------------------------------------------
+
+  // Constructs an object in a free slot. Throws std::bad_alloc if none is free.
+  template <typename... Types>
+  T* acquire( Types&&... values )
+  {
+    const auto p = try_acquire( std::forward<Types>( values )... );
+    if ( p == nullptr )
+      throw std::bad_alloc();
+    return p;
+  }
+
+  // Constructs an object in a free slot, or returns nullptr if none is free
+  template <typename... Types>
+  T* try_acquire( Types&&... values )
+  {
+    index_type slot;
+    {
+      std::scoped_lock lock( lock_ );
+      slot = popFree();
+    }
+    if ( slot == kNil )
+      return nullptr;
+    try
+    {
+      return construct( slot, std::forward<Types>( values )... );
+    }
+    catch ( ... )
+    {
+      std::scoped_lock lock( lock_ );
+      pushFree( slot );
+      throw;
+    }
+  }
+
+  // Destroys an object obtained from this pool and frees its slot
+  void release( T* p ) noexcept
+  {
+    const auto slot = destroy( p );
+    std::scoped_lock lock( lock_ );
+    pushFree( slot );
+  }
+
+  // Observers ----------------------------------------------------------------
+
+  bool owns( const T* p ) const noexcept
+  {
+    const auto bytes = reinterpret_cast<const std::byte*>( p );
+    return bytes >= data_ && bytes < data_ + sizeof( data_ );
+  }
+
+  // Number of live objects; O(Capacity / 64)
+  size_type size() const noexcept
+  {
+    size_type count = 0;
+    for ( const auto& word : occupied_ )
+      count += static_cast<size_type>( std::popcount( loadWord( word ) ) );
+    return count;
+  }
+
+  bool empty() const noexcept
+  {
+    return size() == 0;
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Capacity;
+  }
+
+  // Calls fn( T& ) for each live object in slot order
+  template < typename Fn >
+  void for_each( Fn&& fn )
+  {
+    for ( size_t w = 0; w < kWordCount; ++w )
+    {
+      for ( auto bits = loadWord( occupied_[ w ] ); bits != 0; bits &= bits - 1 )
+        fn( *slotPtr( w * 64 + static_cast<size_t>( std::countr_zero( bits ) ) ) );
+    }
+  }
+
+  template < typename Fn >
+  void for_each( Fn&& fn ) const
+  {
+    for ( size_t w = 0; w < kWordCount; ++w )
+    {
+      for ( auto bits = loadWord( occupied_[ w ] ); bits != 0; bits &= bits - 1 )
+        fn( std::as_const( *slotPtr( w * 64 + static_cast<size_t>( std::countr_zero( bits ) ) ) ) );
+    }
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  //
+  // Per-thread cache of up to CacheCapacity free slots. Refills with half its
+  // capacity under one lock when empty, and returns half when full. Returns every
+  // cached slot to the pool on destruction. Objects may be released through any
+  // cache or the pool itself.
+
+  template < size_t CacheCapacity = 16 >
+  class local_cache
+  {
+    static_assert( CacheCapacity >= 2, "local_cache requires CacheCapacity >= 2" );
+
+  public:
+
+    explicit local_cache( inplace_object_pool& pool ) noexcept
+      : pool_( pool )
+    {
+    }
+
+    local_cache( const local_cache& ) = delete;
+    local_cache& operator=( const local_cache& ) = delete;
+
+    ~local_cache()
+    {
+      pool_.pushFreeBatch( slots_.begin(), slots_.end() );
+    }
+
+    template <typename... Types>
+    T* acquire( Types&&... values )
+    {
+      const auto p = try_acquire( std::forward<Types>( values )... );
+      if ( p == nullptr )
+        throw std::bad_alloc();
+      return p;
+    }
+
+    template <typename... Types>
+    T* try_acquire( Types&&... values )
+    {
+      if ( slots_.empty() )
+        pool_.popFreeBatch( slots_, CacheCapacity / 2 );
+      if ( slots_.empty() )
+        return nullptr;
+      const auto slot = slots_.back();
+      slots_.pop_back();
+      try
+      {
+        return pool_.construct( slot, std::forward<Types>( values )... );
+      }
+      catch ( ... )
+      {
+        slots_.unchecked_push_back( slot );
+        throw;
+      }
+    }
+
+    void release( T* p ) noexcept
+    {
+      const auto slot = pool_.destroy( p );
+      if ( slots_.size() == CacheCapacity )
+      {
+        const auto half = slots_.end() - CacheCapacity / 2;
+        pool_.pushFreeBatch( half, slots_.end() );
+        slots_.erase( half, slots_.end() );
+      }
+      slots_.unchecked_push_back( slot );
+    }
+
+  private:
+
+    inplace_object_pool& pool_;
+    inplace_vector<index_type, CacheCapacity> slots_;
+
+  }; // class local_cache
+
+private:
+
+  T* slotPtr( size_t slot ) noexcept
+  {
+    return reinterpret_cast<T*>( data_ + slot * kSlotSize );
+  }
+
+  const T* slotPtr( size_t slot ) const noexcept
+  {
+    return reinterpret_cast<const T*>( data_ + slot * kSlotSize );
+  }
+
+  static uint64_t loadWord( const word_type& word ) noexcept
+  {
+    if constexpr ( ThreadSafe )
+      return word.load( std::memory_order_acquire );
+    else
+      return word;
+  }
+
+  void setBit( index_type slot ) noexcept
+  {
+    const auto bit = uint64_t( 1 ) << ( slot % 64 );
+    if constexpr ( ThreadSafe )
+      occupied_[ slot / 64 ].fetch_or( bit, std::memory_order_release );
+    else
+      occupied_[ slot / 64 ] |= bit;
+  }
+
+  void clearBit( index_type slot ) noexcept
+  {
+    const auto bit = ~( uint64_t( 1 ) << ( slot % 64 ) );
+    if constexpr ( ThreadSafe )
+      occupied_[ slot / 64 ].fetch_and( bit, std::memory_order_relaxed );
+    else
+      occupied_[ slot / 64 ] &= bit;
+  }
+
+  template <typename... Types>
+  T* construct( index_type slot, Types&&... values )
+  {
+    const auto p = std::construct_at( slotPtr( slot ), std::forward<Types>( values )... );
+    setBit( slot );
+    return p;
+  }
+
+  index_type destroy( T* p ) noexcept
+  {
+    assert( owns( p ) );
+    const auto slot = static_cast<index_type>( static_cast<size_t>( reinterpret_cast<std::byte*>( p ) - data_ ) /
+                                               kSlotSize );
+    assert( ( loadWord( occupied_[ slot / 64 ] ) >> ( slot % 64 ) ) & 1 );
+    clearBit( slot );
+    std::destroy_at( p );
+    return slot;
+  }
+
+  // Free list; callers hold lock_ ---------------------------------------------
+
+  index_type popFree() noexcept
+  {
+    if ( freeHead_ != kNil )
+    {
+      const auto slot = freeHead_;
+      std::memcpy( &freeHead_, data_ + slot * kSlotSize, sizeof( index_type ) );
+      return slot;
+    }
+    return ( usedSlots_ < Capacity ) ? usedSlots_++ : kNil;
+  }
+
+  void pushFree( index_type slot ) noexcept
+  {
+    std::memcpy( data_ + slot * kSlotSize, &freeHead_, sizeof( index_type ) );
+    freeHead_ = slot;
+  }
+
+  template < size_t CacheCapacity >
+  void popFreeBatch( inplace_vector<index_type, CacheCapacity>& slots, size_t count ) noexcept
+  {
+    std::scoped_lock lock( lock_ );
+    for ( ; count > 0; --count )
+    {
+      const auto slot = popFree();
+      if ( slot == kNil )
+        break;
+      slots.unchecked_push_back( slot );
+    }
+  }
+
+  void pushFreeBatch( const index_type* first, const index_type* last ) noexcept
+  {
+    if ( first == last )
+      return;
+    std::scoped_lock lock( lock_ );
+    for ( ; first != last; ++first )
+      pushFree( *first );
+  }
+
+private:
+
+  alignas( kSlotAlign ) std::byte data_[ kSlotSize * Capacity ];
+  std::array<word_type, kWordCount> occupied_{};
+  index_type freeHead_ = kNil;
+  index_type usedSlots_ = 0; // slots at or past this have never been used
+  lock_type lock_;
+
+}; // class inplace_object_pool
+
+} // namespace PKIsensee
+
+#pragma warning(pop)
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,333 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  inplace_priority_queue.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  Fixed-capacity d-ary heap priority queue
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <initializer_list>
+#include <utility>
+#include "inplace_vector.h"
+
+namespace PKIsensee
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Priority queue of at most Capacity elements stored as an implicit d-ary heap in
+// an inplace_vector. The children of element i are Arity * i + 1 through
+// Arity * i + Arity. A wider heap is shallower, so pushes do fewer moves, and with
+// Arity * sizeof( T ) around 64 bytes each sift-down step reads one cache line.
+//
+// Like std::priority_queue, top() is the greatest element under Compare; use
+// std::greater for a min-heap. Pushing onto a full queue throws std::bad_alloc.
+
+template < typename T, size_t Capacity, typename Compare = std::less<T>, size_t Arity = 4 >
+class inplace_priority_queue
+{
+  static_assert( Arity >= 2, "inplace_priority_queue requires Arity >= 2" );
+
+public:
+
+  using container_type  = inplace_vector<T, Capacity>;
+  using value_compare   = Compare;
+  using value_type      = T;
+  using size_type       = size_t;
+  using reference       = T&;
+  using const_reference = const T&;
+  using const_iterator  = typename container_type::const_iterator;
+
+  static constexpr size_type arity = Arity;
+
+  // Constructors -------------------------------------------------------------
+
+  constexpr inplace_priority_queue() = default;
+
+  constexpr explicit inplace_priority_queue( const Compare& comp )
+    : comp_( comp )
+  {
+  }
+
+  template < std::input_iterator InIt >
+  constexpr inplace_priority_queue( InIt first, InIt last, const Compare& comp = Compare() )
+    : comp_( comp )
+  {
+    heapify( first, last );
+  }
+
+  constexpr inplace_priority_queue( std::initializer_list<T> iList, const Compare& comp = Compare() )
+    : comp_( comp )
+  {
+    heapify( iList.begin(), iList.end() );
+  }
+
+  // Element access -----------------------------------------------------------
+
+  constexpr const_reference top() const
+  {
+    assert( !empty() );
+    return c_[ 0 ];
+  }
+
+  // Elements in heap order; indices are valid for decrease_key() and update()
+  constexpr const_reference operator[]( size_type i ) const
+  {
+    return c_[ i ];
+  }
+
+  constexpr const_iterator begin() const noexcept
+  {
+    return c_.begin();
+  }
+
+  constexpr const_iterator end() const noexcept
+  {
+    return c_.end();
+  }
+
+  // Size and capacity --------------------------------------------------------
+
+  constexpr bool empty() const noexcept
+  {
+    return c_.empty();
+  }
+
+  constexpr size_type size() const noexcept
+  {
+    return c_.size();
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Capacity;
+  }
+
+  // Modifiers ----------------------------------------------------------------
+
+  constexpr void push( const T& value )
+  {
+    c_.push_back( value );
+    siftUp( size() - 1 );
+  }
+
+  constexpr void push( T&& value )
+  {
+    c_.push_back( std::move( value ) );
+    siftUp( size() - 1 );
+  }
+
+  template <typename... Types>
+  constexpr void emplace( Types&&... values )
+  {
+    c_.emplace_back( std::forward<Types>( values )... );
+    siftUp( size() - 1 );
+  }
+
+  template <typename... Types>
+  constexpr bool try_emplace( Types&&... values )
+  {
+    // Returns false if the queue is full
+    if ( c_.try_emplace_back( std::forward<Types>( values )... ) == nullptr )
+      return false;
+    siftUp( size() - 1 );
+    return true;
+  }
+
+  constexpr void pop()
+  {
+    assert( !empty() );
+    if ( size() > 1 )
+    {
+      T last = std::move( c_.back() );
+      c_.pop_back();
+      siftDown( 0, std::move( last ) );
+    }
+    else
+      c_.pop_back();
+  }
+
+  // Replaces the top element with value; one sift-down instead of pop() plus push()
+  constexpr void replace_top( T value )
+  {
+    assert( !empty() );
+    siftDown( 0, std::move( value ) );
+  }
+
+  // Replaces element i with value, which must order no lower than it (a smaller
+  // key in a std::greater min-heap), and moves it toward the top
+  constexpr void decrease_key( size_type i, T value )
+  {
+    assert( i < size() );
+    assert( !comp_( value, c_[ i ] ) );
+    c_[ i ] = std::move( value );
+    siftUp( i );
+  }
+
+  // Replaces element i with value and restores the heap in either direction
+  constexpr void update( size_type i, T value )
+  {
+    assert( i < size() );
+    if ( comp_( c_[ i ], value ) )
+    {
+      c_[ i ] = std::move( value );
+      siftUp( i );
+    }
+    else
+      siftDown( i, std::move( value ) );
+  }
+
+  // Adds [first, last) and rebuilds the heap bottom-up in linear time. Throws
+  // std::bad_alloc, leaving the queue unchanged, if the elements don't fit.
+  template < std::input_iterator InIt >
+  constexpr void heapify( InIt first, InIt last )
+  {
+    heapify_range( std::ranges::subrange( first, last ) );
+  }
+
+  template < typename Range >
+  constexpr void heapify_range( Range&& rng )
+  {
+    // Appends one at a time, so single-pass and unsized ranges work too
+    const auto n = size();
+    try
+    {
+      for ( auto&& value : rng )
+        c_.emplace_back( std::forward<decltype( value )>( value ) );
+    }
+    catch ( ... )
+    {
+      c_.erase( c_.begin() + n, c_.end() );
+      throw;
+    }
+    makeHeap();
+  }
+
+  constexpr void clear() noexcept
+  {
+    c_.clear();
+  }
+
+  constexpr void swap( inplace_priority_queue& rhs )
+  {
+    c_.swap( rhs.c_ );
+    std::swap( comp_, rhs.comp_ );
+  }
+
+  // Observers ----------------------------------------------------------------
+
+  constexpr const container_type& container() const noexcept
+  {
+    return c_;
+  }
+
+  constexpr value_compare value_comp() const
+  {
+    return comp_;
+  }
+
+  // Non-member functions -----------------------------------------------------
+
+  friend constexpr void swap( inplace_priority_queue& lhs, inplace_priority_queue& rhs )
+  {
+    lhs.swap( rhs );
+  }
+
+private:
+
+  static constexpr size_type parentOf( size_type i ) noexcept
+  {
+    return ( i - 1 ) / Arity;
+  }
+
+  constexpr void siftUp( size_type i )
+  {
+    // Moves parents down into the hole until value's position is found
+    if ( i == 0 )
+      return;
+    T value = std::move( c_[ i ] );
+    while ( i > 0 )
+    {
+      const auto parent = parentOf( i );
+      if ( !comp_( c_[ parent ], value ) )
+        break;
+      c_[ i ] = std::move( c_[ parent ] );
+      i = parent;
+    }
+    c_[ i ] = std::move( value );
+  }
+
+  template < size_t First, size_t Count >
+  constexpr size_t tournament( const T* children ) const
+  {
+    // Pairwise reduction; the comparisons at each level are independent, so the
+    // critical path is log2( Arity ) dependent selects instead of Arity - 1
+    if constexpr ( Count == 1 )
+      return First;
+    else
+    {
+      const auto a = tournament<First, Count / 2>( children );
+      const auto b = tournament<First + Count / 2, Count - Count / 2>( children );
+      return comp_( children[ a ], children[ b ] ) ? b : a;
+    }
+  }
+
+  constexpr size_type bestChild( size_type first, size_type count ) const
+  {
+    if ( first + Arity <= count )
+      return first + tournament<0, Arity>( std::addressof( c_[ first ] ) );
+    auto best = first;
+    for ( auto child = first + 1; child < count; ++child )
+      best = comp_( c_[ best ], c_[ child ] ) ? child : best;
+    return best;
+  }
+
+  constexpr void siftDown( size_type i, T value )
+  {
+    // Moves the greatest child up into the hole at i until value fits there
+    const auto count = size();
+    for ( auto first = Arity * i + 1; first < count; first = Arity * i + 1 )
+    {
+      const auto best = bestChild( first, count );
+      if ( !comp_( value, c_[ best ] ) )
+        break;
+      c_[ i ] = std::move( c_[ best ] );
+      i = best;
+    }
+    c_[ i ] = std::move( value );
+  }
+
+  constexpr void makeHeap()
+  {
+    if ( size() < 2 )
+      return;
+    for ( auto i = parentOf( size() - 1 ) + 1; i-- > 0; )
+    {
+      T value = std::move( c_[ i ] );
+      siftDown( i, std::move( value ) );
+    }
+  }
+
+private:
+
+  container_type c_;
+  [[no_unique_address]] Compare comp_;
+
+}; // class inplace_priority_queue
+
+} // namespace PKIsensee
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,322 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  inplace_slot_map.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  Fixed-capacity generational slot map with stable handles
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <array>
+#include <utility>
+#include "inplace_algorithm.h"
+#include "inplace_vector.h"
+
+namespace PKIsensee
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Handle to an element of an inplace_slot_map with the same Capacity. Packs the
+// slot index into the low bits and the slot's generation into the rest of a
+// 32-bit word, or a 64-bit word if Capacity needs more than 24 index bits.
+// Occupied slots have odd generations, so a default-constructed handle is null.
+
+template < size_t Capacity >
+class slot_handle
+{
+public:
+
+  static constexpr int kIndexBits = std::bit_width( Capacity );
+  using storage_type = std::conditional_t< kIndexBits <= 24, uint32_t, uint64_t >;
+  static constexpr int kGenerationBits = static_cast<int>( sizeof( storage_type ) * 8 ) - kIndexBits;
+  static constexpr storage_type kIndexMask = ( storage_type( 1 ) << kIndexBits ) - 1;
+  static constexpr storage_type kGenerationMask = static_cast<storage_type>( ~storage_type( 0 ) >> kIndexBits );
+
+  constexpr slot_handle() noexcept = default;
+
+  constexpr slot_handle( size_t index, storage_type generation ) noexcept
+    : bits_( static_cast<storage_type>( ( generation & kGenerationMask ) << kIndexBits ) |
+             static_cast<storage_type>( index ) )
+  {
+    assert( index <= kIndexMask );
+  }
+
+  constexpr size_t index() const noexcept
+  {
+    return static_cast<size_t>( bits_ & kIndexMask );
+  }
+
+  constexpr storage_type generation() const noexcept
+  {
+    return static_cast<storage_type>( bits_ >> kIndexBits );
+  }
+
+  constexpr storage_type bits() const noexcept
+  {
+    return bits_;
+  }
+
+  constexpr explicit operator bool() const noexcept
+  {
+    return generation() != 0;
+  }
+
+  friend constexpr bool operator==( slot_handle, slot_handle ) noexcept = default;
+
+private:
+
+  storage_type bits_ = 0;
+
+}; // class slot_handle
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Container of at most Capacity elements addressed by slot_handles that stay
+// valid until their element is erased. Values are stored densely in an
+// inplace_vector for iteration; erase moves the last value into the hole. A slot
+// array maps handle indices to dense positions, and free slots reuse that field
+// as the link of an embedded free list. Each erase advances the slot's
+// generation, so stale handles fail lookup in O(1).
+//
+// Insert, erase and lookup are O(1). Performs no memory allocations; inserting
+// into a full map throws std::bad_alloc. A generation wraps after 2^(bits - 1)
+// reuses of one slot, after which a very old handle could match again.
+
+template < typename T, size_t Capacity >
+class inplace_slot_map
+{
+  using index_type = detail::IndexFor<Capacity>;
+
+  static constexpr index_type kNil = static_cast<index_type>( Capacity );
+
+public:
+
+  using value_type      = T;
+  using handle          = slot_handle<Capacity>;
+  using size_type       = size_t;
+  using reference       = T&;
+  using const_reference = const T&;
+  using container_type  = inplace_vector<T, Capacity>;
+  using iterator        = typename container_type::iterator;
+  using const_iterator  = typename container_type::const_iterator;
+
+  // Constructors -------------------------------------------------------------
+
+  constexpr inplace_slot_map() noexcept = default;
+
+  // Iterators ----------------------------------------------------------------
+
+  // Dense iteration over live values in unspecified order
+  iterator begin() noexcept
+  {
+    return values_.begin();
+  }
+
+  const_iterator begin() const noexcept
+  {
+    return values_.begin();
+  }
+
+  iterator end() noexcept
+  {
+    return values_.end();
+  }
+
+  const_iterator end() const noexcept
+  {
+    return values_.end();
+  }
+
+  // Handle of the element at pos
+  handle handle_of( const_iterator pos ) const noexcept
+  {
+    const auto slot = denseToSlot_[ static_cast<size_type>( pos - values_.begin() ) ];
+    return handle( slot, slots_[ slot ].generation );
+  }
+
+  // Size and capacity --------------------------------------------------------
+
+  bool empty() const noexcept
+  {
+    return values_.empty();
+  }
+
+  size_type size() const noexcept
+  {
+    return values_.size();
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Capacity;
+  }
+
+  // Element access -----------------------------------------------------------
+
+  // Returns nullptr if h is null or stale
+  T* get( handle h ) noexcept
+  {
+    return isLive( h ) ? &values_[ slots_[ h.index() ].dense ] : nullptr;
+  }
+
+  const T* get( handle h ) const noexcept
+  {
+    return isLive( h ) ? &values_[ slots_[ h.index() ].dense ] : nullptr;
+  }
+
+  bool contains( handle h ) const noexcept
+  {
+    return isLive( h );
+  }
+
+  T& operator[]( handle h )
+  {
+    assert( isLive( h ) );
+    return values_[ slots_[ h.index() ].dense ];
+  }
+
+  const T& operator[]( handle h ) const
+  {
+    assert( isLive( h ) );
+    return values_[ slots_[ h.index() ].dense ];
+  }
+
+  T& at( handle h )
+  {
+    if ( !isLive( h ) )
+      throw std::out_of_range( "inplace_slot_map::at" );
+    return values_[ slots_[ h.index() ].dense ];
+  }
+
+  const T& at( handle h ) const
+  {
+    if ( !isLive( h ) )
+      throw std::out_of_range( "inplace_slot_map::at" );
+    return values_[ slots_[ h.index() ].dense ];
+  }
+
+  // Modifiers ----------------------------------------------------------------
+
+  template <typename... Types>
+  handle emplace( Types&&... values )
+  {
+    if ( size() == Capacity )
+      throw std::bad_alloc();
+    return emplaceUnchecked( std::forward<Types>( values )... );
+  }
+
+  handle insert( const T& value )
+  {
+    return emplace( value );
+  }
+
+  handle insert( T&& value )
+  {
+    return emplace( std::move( value ) );
+  }
+
+  // Returns a null handle if the map is full
+  template <typename... Types>
+  handle try_emplace( Types&&... values )
+  {
+    if ( size() == Capacity )
+      return handle();
+    return emplaceUnchecked( std::forward<Types>( values )... );
+  }
+
+  // Returns false if h is null or stale
+  bool erase( handle h )
+  {
+    if ( !isLive( h ) )
+      return false;
+    const auto slot = static_cast<index_type>( h.index() );
+    const auto dense = slots_[ slot ].dense;
+    const auto last = static_cast<index_type>( size() - 1 );
+    if ( dense != last )
+    {
+      values_[ dense ] = std::move( values_[ last ] );
+      denseToSlot_[ dense ] = denseToSlot_[ last ];
+      slots_[ denseToSlot_[ dense ] ].dense = dense;
+    }
+    values_.pop_back();
+    release( slot );
+    return true;
+  }
+
+  void clear() noexcept
+  {
+    // Invalidates every outstanding handle
+    for ( size_type i = 0; i < size(); ++i )
+      release( denseToSlot_[ i ] );
+    values_.clear();
+  }
+
+private:
+
+  struct Slot
+  {
+    index_type dense = kNil; // position in values_, or next free slot
+    typename handle::storage_type generation = 0; // odd while occupied
+  };
+
+  bool isLive( handle h ) const noexcept
+  {
+    return h.index() < usedSlots_ && ( h.generation() & 1 ) != 0 &&
+           slots_[ h.index() ].generation == h.generation();
+  }
+
+  template <typename... Types>
+  handle emplaceUnchecked( Types&&... values )
+  {
+    // Construct first so a throwing constructor leaves the slots untouched
+    values_.unchecked_emplace_back( std::forward<Types>( values )... );
+    index_type slot;
+    if ( freeHead_ != kNil )
+    {
+      slot = freeHead_;
+      freeHead_ = slots_[ slot ].dense;
+    }
+    else
+      slot = usedSlots_++;
+    const auto dense = static_cast<index_type>( size() - 1 );
+    auto& s = slots_[ slot ];
+    s.dense = dense;
+    s.generation = ( s.generation + 1 ) & handle::kGenerationMask;
+    denseToSlot_[ dense ] = slot;
+    return handle( slot, s.generation );
+  }
+
+  void release( index_type slot ) noexcept
+  {
+    auto& s = slots_[ slot ];
+    s.generation = ( s.generation + 1 ) & handle::kGenerationMask; // even: free
+    s.dense = freeHead_;
+    freeHead_ = slot;
+  }
+
+private:
+
+  container_type values_;
+  std::array<index_type, Capacity> denseToSlot_{};
+  std::array<Slot, Capacity> slots_{};
+  index_type freeHead_ = kNil;
+  index_type usedSlots_ = 0; // slots at or past this have never been used
+
+}; // class inplace_slot_map
+
+} // namespace PKIsensee
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,326 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  inplace_sparse_set.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  Sparse sets of small integers with O(1) operations and dense iteration
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <array>
+#include <initializer_list>
+#include <utility>
+#include "inplace_algorithm.h"
+#include "inplace_flat_map.h"
+#include "inplace_vector.h"
+
+namespace PKIsensee
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Set of integers in [0, Universe). Members are stored densely in an inplace_vector
+// and a sparse array maps each value to its dense position. A value is a member
+// only if its sparse entry points at a dense slot holding that value, so stale
+// entries are harmless: clear() just empties the dense array. The sparse array is
+// zeroed once on construction, never again.
+//
+// insert, erase, contains and clear are O(1); iteration visits only members, in
+// unspecified order. erase moves the last member into the hole. Performs no
+// memory allocations.
+
+template < size_t Universe >
+class inplace_sparse_set
+{
+public:
+
+  using value_type     = detail::IndexFor<Universe>;
+  using size_type      = size_t;
+  using container_type = inplace_vector<value_type, Universe>;
+  using const_iterator = typename container_type::const_iterator;
+  using iterator       = const_iterator;
+
+  // Constructors -------------------------------------------------------------
+
+  inplace_sparse_set() = default;
+
+  inplace_sparse_set( std::initializer_list<value_type> iList )
+  {
+    for ( auto value : iList )
+      insert( value );
+  }
+
+  // Iterators ----------------------------------------------------------------
+
+  const_iterator begin() const noexcept
+  {
+    return dense_.begin();
+  }
+
+  const_iterator end() const noexcept
+  {
+    return dense_.end();
+  }
+
+  // Size and capacity --------------------------------------------------------
+
+  bool empty() const noexcept
+  {
+    return dense_.empty();
+  }
+
+  size_type size() const noexcept
+  {
+    return dense_.size();
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Universe;
+  }
+
+  // Modifiers ----------------------------------------------------------------
+
+  // Returns false if value was already a member
+  bool insert( size_t value )
+  {
+    if ( contains( value ) )
+      return false;
+    sparse_[ value ] = static_cast<value_type>( size() );
+    dense_.unchecked_push_back( static_cast<value_type>( value ) );
+    return true;
+  }
+
+  // Returns false if value was not a member
+  bool erase( size_t value )
+  {
+    if ( !contains( value ) )
+      return false;
+    const auto pos = sparse_[ value ];
+    const auto last = dense_.back();
+    dense_[ pos ] = last;
+    sparse_[ last ] = pos;
+    dense_.pop_back();
+    return true;
+  }
+
+  void clear() noexcept
+  {
+    dense_.clear();
+  }
+
+  // Lookup -------------------------------------------------------------------
+
+  bool contains( size_t value ) const noexcept
+  {
+    assert( value < Universe );
+    const auto pos = sparse_[ value ];
+    return pos < size() && dense_[ pos ] == value;
+  }
+
+  // Dense position of value, valid until the next erase; value must be a member
+  size_type index_of( size_t value ) const noexcept
+  {
+    assert( contains( value ) );
+    return sparse_[ value ];
+  }
+
+  const container_type& members() const noexcept
+  {
+    return dense_;
+  }
+
+private:
+
+  container_type dense_;
+  std::array<value_type, Universe> sparse_{};
+
+}; // class inplace_sparse_set
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// inplace_sparse_set that attaches a value of type T to each member. Values live
+// in an inplace_vector parallel to the dense members, so iteration over either is
+// contiguous. Iterators dereference to std::pair<const Key&, T&>. Only live values
+// are constructed; clear() destroys them, which is O(1) for trivially
+// destructible T.
+
+template < typename T, size_t Universe >
+class inplace_sparse_map
+{
+public:
+
+  using key_type              = detail::IndexFor<Universe>;
+  using mapped_type           = T;
+  using size_type             = size_t;
+  using key_container_type    = inplace_vector<key_type, Universe>;
+  using mapped_container_type = inplace_vector<T, Universe>;
+  using iterator              = detail::flatMapIterator<key_type, T, false>;
+  using const_iterator        = detail::flatMapIterator<key_type, T, true>;
+
+  // Constructors -------------------------------------------------------------
+
+  inplace_sparse_map() = default;
+
+  // Iterators ----------------------------------------------------------------
+
+  iterator begin() noexcept
+  {
+    return { keys_.begin(), values_.begin() };
+  }
+
+  const_iterator begin() const noexcept
+  {
+    return { keys_.begin(), values_.begin() };
+  }
+
+  iterator end() noexcept
+  {
+    return { keys_.end(), values_.end() };
+  }
+
+  const_iterator end() const noexcept
+  {
+    return { keys_.end(), values_.end() };
+  }
+
+  // Size and capacity --------------------------------------------------------
+
+  bool empty() const noexcept
+  {
+    return keys_.empty();
+  }
+
+  size_type size() const noexcept
+  {
+    return keys_.size();
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Universe;
+  }
+
+  // Element access -----------------------------------------------------------
+
+  // Returns nullptr if key is not a member
+  T* find( size_t key ) noexcept
+  {
+    return contains( key ) ? &values_[ sparse_[ key ] ] : nullptr;
+  }
+
+  const T* find( size_t key ) const noexcept
+  {
+    return contains( key ) ? &values_[ sparse_[ key ] ] : nullptr;
+  }
+
+  T& operator[]( size_t key )
+    requires( std::default_initializable<T> )
+  {
+    return *emplace( key ).first;
+  }
+
+  T& at( size_t key )
+  {
+    if ( !contains( key ) )
+      throw std::out_of_range( "inplace_sparse_map::at" );
+    return values_[ sparse_[ key ] ];
+  }
+
+  const T& at( size_t key ) const
+  {
+    if ( !contains( key ) )
+      throw std::out_of_range( "inplace_sparse_map::at" );
+    return values_[ sparse_[ key ] ];
+  }
+
+  // Modifiers ----------------------------------------------------------------
+
+  // Constructs a value for key if key is absent. Returns the value for key and
+  // whether it was inserted.
+  template <typename... Types>
+  std::pair<T*, bool> emplace( size_t key, Types&&... values )
+  {
+    if ( contains( key ) )
+      return { &values_[ sparse_[ key ] ], false };
+    auto& value = values_.unchecked_emplace_back( std::forward<Types>( values )... );
+    sparse_[ key ] = static_cast<key_type>( size() );
+    keys_.unchecked_push_back( static_cast<key_type>( key ) );
+    return { &value, true };
+  }
+
+  template <typename V>
+  std::pair<T*, bool> insert_or_assign( size_t key, V&& value )
+  {
+    auto result = emplace( key, std::forward<V>( value ) );
+    if ( !result.second )
+      *result.first = std::forward<V>( value );
+    return result;
+  }
+
+  // Returns false if key was not a member
+  bool erase( size_t key )
+  {
+    if ( !contains( key ) )
+      return false;
+    const auto pos = sparse_[ key ];
+    const auto last = keys_.back();
+    if ( last != key )
+    {
+      keys_[ pos ] = last;
+      values_[ pos ] = std::move( values_.back() );
+      sparse_[ last ] = pos;
+    }
+    keys_.pop_back();
+    values_.pop_back();
+    return true;
+  }
+
+  void clear() noexcept
+  {
+    keys_.clear();
+    values_.clear();
+  }
+
+  // Lookup -------------------------------------------------------------------
+
+  bool contains( size_t key ) const noexcept
+  {
+    assert( key < Universe );
+    const auto pos = sparse_[ key ];
+    return pos < size() && keys_[ pos ] == key;
+  }
+
+  const key_container_type& keys() const noexcept
+  {
+    return keys_;
+  }
+
+  const mapped_container_type& values() const noexcept
+  {
+    return values_;
+  }
+
+private:
+
+  key_container_type keys_;
+  mapped_container_type values_;
+  std::array<key_type, Universe> sparse_{};
+
+}; // class inplace_sparse_map
+
+} // namespace PKIsensee
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,228 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  inplace_spsc_queue.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  Wait-free single-producer single-consumer ring queue
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <span>
+#include "inplace_vector.h"
+
+#pragma warning(push)
+#pragma warning(disable: 26495) // "data_ is uninitialized", by design
+#pragma warning(disable: 4324)  // "structure was padded due to alignment specifier", by design
+
+namespace PKIsensee
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Bounded FIFO for exactly one producer thread and one consumer thread. Elements
+// are constructed in place in an uninitialized ring, like inplace_vector's data_.
+// head and tail are free-running counters on separate cache lines. Each side keeps
+// a private copy of the other side's counter and rereads the shared one only when
+// the copy says the ring is full (producer) or empty (consumer). In steady state,
+// then, neither side touches the other's cache line. Every operation completes in
+// a bounded number of steps; none allocates.
+//
+// try_push_n() and try_pop_n() transfer as many elements as fit, in at most two
+// contiguous runs, with one counter update per batch. Capacity need not be a power
+// of two, but one makes the index arithmetic a mask.
+
+template < typename T, size_t Capacity >
+class inplace_spsc_queue
+{
+  static_assert( Capacity > 0, "inplace_spsc_queue requires Capacity > 0" );
+
+public:
+
+  using value_type = T;
+  using size_type  = size_t;
+
+  // Constructors -------------------------------------------------------------
+
+  inplace_spsc_queue() = default;
+
+  inplace_spsc_queue( const inplace_spsc_queue& ) = delete;
+  inplace_spsc_queue& operator=( const inplace_spsc_queue& ) = delete;
+
+  ~inplace_spsc_queue()
+  {
+    if constexpr ( !std::is_trivially_destructible_v<T> )
+    {
+      const auto tail = tail_.load( std::memory_order_acquire );
+      for ( auto i = head_.load( std::memory_order_relaxed ); i != tail; ++i )
+        std::destroy_at( ptr( i ) );
+    }
+  }
+
+  // Producer -----------------------------------------------------------------
+
+  // Returns false if the queue is full
+  template <typename... Types>
+  bool try_emplace( Types&&... values )
+  {
+    const auto tail = tail_.load( std::memory_order_relaxed );
+    if ( tail - cachedHead_ == Capacity )
+    {
+      cachedHead_ = head_.load( std::memory_order_acquire );
+      if ( tail - cachedHead_ == Capacity )
+        return false;
+    }
+    std::construct_at( ptr( tail ), std::forward<Types>( values )... );
+    tail_.store( tail + 1, std::memory_order_release );
+    return true;
+  }
+
+  bool try_push( const T& value )
+  {
+    return try_emplace( value );
+  }
+
+  bool try_push( T&& value )
+  {
+    return try_emplace( std::move( value ) );
+  }
+
+  // Copies as many of values as fit; returns the number pushed
+  size_type try_push_n( std::span<const T> values )
+  {
+    const auto tail = tail_.load( std::memory_order_relaxed );
+    if ( Capacity - ( tail - cachedHead_ ) < values.size() )
+      cachedHead_ = head_.load( std::memory_order_acquire );
+    const auto count = std::min( Capacity - ( tail - cachedHead_ ), values.size() );
+    if ( count == 0 )
+      return 0;
+
+    const auto first = static_cast<size_t>( tail % Capacity );
+    const auto run = std::min( count, Capacity - first );
+    std::uninitialized_copy_n( values.begin(), run, ptr( tail ) );
+    try
+    {
+      std::uninitialized_copy_n( values.begin() + static_cast<ptrdiff_t>( run ), count - run, ptr( 0 ) );
+    }
+    catch ( ... )
+    {
+      std::destroy_n( ptr( tail ), run );
+      throw;
+    }
+    tail_.store( tail + count, std::memory_order_release );
+    return count;
+  }
+
+  // Consumer -----------------------------------------------------------------
+
+  // Returns the oldest element without removing it, or nullptr if empty
+  T* front() noexcept
+  {
+    const auto head = head_.load( std::memory_order_relaxed );
+    if ( head == cachedTail_ )
+    {
+      cachedTail_ = tail_.load( std::memory_order_acquire );
+      if ( head == cachedTail_ )
+        return nullptr;
+    }
+    return ptr( head );
+  }
+
+  // Removes the oldest element; front() must have returned non-null
+  void pop() noexcept
+  {
+    const auto head = head_.load( std::memory_order_relaxed );
+    assert( head != cachedTail_ );
+    std::destroy_at( ptr( head ) );
+    head_.store( head + 1, std::memory_order_release );
+  }
+
+  // Moves the oldest element into value; returns false if the queue is empty
+  bool try_pop( T& value )
+  {
+    const auto p = front();
+    if ( p == nullptr )
+      return false;
+    value = std::move( *p );
+    pop();
+    return true;
+  }
+
+  // Moves up to out.size() elements into out; returns the number popped
+  size_type try_pop_n( std::span<T> out )
+  {
+    const auto head = head_.load( std::memory_order_relaxed );
+    if ( cachedTail_ - head < out.size() )
+      cachedTail_ = tail_.load( std::memory_order_acquire );
+    const auto count = std::min( cachedTail_ - head, out.size() );
+    if ( count == 0 )
+      return 0;
+
+    const auto first = static_cast<size_t>( head % Capacity );
+    const auto run = std::min( count, Capacity - first );
+    std::move( ptr( head ), ptr( head ) + run, out.begin() );
+    std::move( ptr( 0 ), ptr( 0 ) + ( count - run ), out.begin() + static_cast<ptrdiff_t>( run ) );
+    std::destroy_n( ptr( head ), run );
+    std::destroy_n( ptr( 0 ), count - run );
+    head_.store( head + count, std::memory_order_release );
+    return count;
+  }
+
+  // Observers ----------------------------------------------------------------
+
+  // Exact only when called from the producer or consumer with the other idle
+  size_type size_approx() const noexcept
+  {
+    const auto head = head_.load( std::memory_order_acquire );
+    const auto tail = tail_.load( std::memory_order_acquire );
+    return static_cast<size_type>( tail - head );
+  }
+
+  bool empty_approx() const noexcept
+  {
+    return size_approx() == 0;
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Capacity;
+  }
+
+private:
+
+  T* ptr( uint64_t index ) noexcept
+  {
+    return reinterpret_cast<T*>( data_ ) + static_cast<size_t>( index % Capacity );
+  }
+
+private:
+
+  // Free-running counters; 64 bits never wrap in practice
+  alignas( detail::kCacheLineSize ) std::atomic<uint64_t> tail_ = 0; // written by producer
+  uint64_t cachedHead_ = 0;                                          // producer's copy of head_
+
+  alignas( detail::kCacheLineSize ) std::atomic<uint64_t> head_ = 0; // written by consumer
+  uint64_t cachedTail_ = 0;                                          // consumer's copy of tail_
+
+  alignas( std::max( alignof( T ), detail::kCacheLineSize ) ) std::byte data_[ sizeof( T ) * Capacity ];
+
+}; // class inplace_spsc_queue
+
+} // namespace PKIsensee
+
+#pragma warning(pop)
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,413 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  inplace_thread_pool.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  Thread pool with inline task storage and work stealing
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include "inplace_mpmc_queue.h"
+#include "inplace_vector.h"
+
+#pragma warning(push)
+#pragma warning(disable: 4324)  // "structure was padded due to alignment specifier", by design
+
+namespace PKIsensee
+{
+
+namespace detail
+{
+  // Move-only type-erased void() callable stored in Bytes of inline storage. A
+  // callable that doesn't fit is a compile-time error, never a heap allocation.
+  template < size_t Bytes >
+  class inplaceTask
+  {
+  public:
+
+    inplaceTask() = default;
+
+    template < typename Fn >
+      requires( !std::is_same_v<std::remove_cvref_t<Fn>, inplaceTask> )
+    explicit inplaceTask( Fn&& fn ) noexcept( std::is_nothrow_constructible_v<std::decay_t<Fn>, Fn> )
+    {
+      using F = std::decay_t<Fn>;
+      static_assert( sizeof( F ) <= Bytes && alignof( F ) <= alignof( std::max_align_t ),
+                     "callable too large for inline task storage" );
+      static_assert( std::is_nothrow_move_constructible_v<F>, "task callables require nothrow move" );
+      std::construct_at( reinterpret_cast<F*>( data_ ), std::forward<Fn>( fn ) );
+      ops_ = &kOps<F>;
+    }
+
+    inplaceTask( inplaceTask&& rhs ) noexcept
+    {
+      moveFrom( rhs );
+    }
+
+    inplaceTask& operator=( inplaceTask&& rhs ) noexcept
+    {
+      if ( this != &rhs )
+      {
+        reset();
+        moveFrom( rhs );
+      }
+      return *this;
+    }
+
+    ~inplaceTask()
+    {
+      reset();
+    }
+
+    explicit operator bool() const noexcept
+    {
+      return ops_ != nullptr;
+    }
+
+    void operator()()
+    {
+      assert( ops_ != nullptr );
+      ops_->invoke( data_ );
+    }
+
+  private:
+
+    struct operations
+    {
+      void ( *invoke )( std::byte* );
+      void ( *relocate )( std::byte* dst, std::byte* src ) noexcept;
+      void ( *destroy )( std::byte* ) noexcept;
+    };
+
+    template < typename F >
+    static constexpr operations kOps
+    {
+      []( std::byte* p ) { ( *reinterpret_cast<F*>( p ) )(); },
+      []( std::byte* dst, std::byte* src ) noexcept
+      {
+        std::construct_at( reinterpret_cast<F*>( dst ), std::move( *reinterpret_cast<F*>( src ) ) );
+        std::destroy_at( reinterpret_cast<F*>( src ) );
+      },
+      []( std::byte* p ) noexcept { std::destroy_at( reinterpret_cast<F*>( p ) ); }
+    };
+
+    void moveFrom( inplaceTask& rhs ) noexcept
+    {
+      if ( rhs.ops_ != nullptr )
+      {
+        rhs.ops_->relocate( data_, rhs.data_ );
+        ops_ = std::exchange( rhs.ops_, nullptr );
+      }
+    }
+
+    void reset() noexcept
+    {
+      if ( ops_ != nullptr )
+        std::exchange( ops_, nullptr )->destroy( data_ );
+    }
+
+  private:
+
+    const operations* ops_ = nullptr;
+    alignas( std::max_align_t ) std::byte data_[ Bytes ];
+
+  }; // class inplaceTask
+
+  // Identifies the pool and worker running on the current thread, if any
+  struct poolWorker
+  {
+    const void* pool = nullptr;
+    size_t index = 0;
+  };
+
+  inline thread_local poolWorker tlsPoolWorker;
+
+}; // namespace detail
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Pool of WorkerCount threads. Each worker owns an inplace_mpmc_queue of
+// QueueCapacity tasks. Tasks are callables of at most TaskBytes, stored inline in
+// the queue slots, so submitting a task never allocates. Only starting the worker
+// threads does. A task submitted from a worker goes to that worker's queue;
+// others are spread round-robin. A worker whose queue is empty steals from the
+// others' queues, and it sleeps on an atomic wait (a futex on Linux, WaitOnAddress
+// on Windows) once a short spin finds nothing. Submitters notify only while some
+// worker sleeps.
+//
+// try_submit() returns false when every queue is full; submit() throws
+// std::bad_alloc. Tasks must not throw. Destruction runs every queued task, then
+// joins the workers.
+
+template < size_t WorkerCount, size_t QueueCapacity = 256, size_t TaskBytes = 48 >
+class inplace_thread_pool
+{
+  static_assert( WorkerCount > 0, "inplace_thread_pool requires WorkerCount > 0" );
+
+public:
+
+  using task_type = detail::inplaceTask<TaskBytes>;
+  using size_type = size_t;
+
+  // Constructors -------------------------------------------------------------
+
+  inplace_thread_pool()
+  {
+    try
+    {
+      for ( size_t i = 0; i < WorkerCount; ++i )
+        threads_[ i ] = std::thread( [ this, i ] { workerLoop( i ); } );
+    }
+    catch ( ... )
+    {
+      // The destructor won't run; stop the workers already started so their
+      // joinable threads don't terminate the program
+      stopWorkers();
+      throw;
+    }
+  }
+
+  inplace_thread_pool( const inplace_thread_pool& ) = delete;
+  inplace_thread_pool& operator=( const inplace_thread_pool& ) = delete;
+
+  ~inplace_thread_pool()
+  {
+    stopWorkers();
+  }
+
+  // Submission ---------------------------------------------------------------
+
+  // Queues fn( ) to run on some worker; returns false if every queue is full
+  template < typename Fn >
+  bool try_submit( Fn&& fn )
+  {
+    task_type task( std::forward<Fn>( fn ) );
+    const auto start = isWorker() ? detail::tlsPoolWorker.index :
+                                    nextQueue_.fetch_add( 1, std::memory_order_relaxed );
+    for ( size_t k = 0; k < WorkerCount; ++k )
+    {
+      if ( queues_[ ( start + k ) % WorkerCount ].try_push( std::move( task ) ) ) // moved only on success
+      {
+        wakeOne();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  template < typename Fn >
+  void submit( Fn&& fn )
+  {
+    if ( !try_submit( std::forward<Fn>( fn ) ) )
+      throw std::bad_alloc();
+  }
+
+  // Runs one queued task on the calling thread, preferring the caller's own queue
+  // if it is a worker. Returns false if no task was found.
+  bool run_pending()
+  {
+    const auto start = isWorker() ? detail::tlsPoolWorker.index : 0;
+    task_type task;
+    for ( size_t k = 0; k < WorkerCount; ++k )
+    {
+      if ( queues_[ ( start + k ) % WorkerCount ].try_pop( task ) )
+      {
+        task();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Calls fn( i ) for each i in [first, last). Workers and the caller claim chunks
+  // of Grain indices from a shared counter until none remain. The caller runs
+  // queued tasks while it waits for the helpers, so nested calls from workers
+  // can't deadlock. fn must not throw on a worker.
+  template < size_t Grain = 256, typename Fn >
+  void parallel_for( size_t first, size_t last, Fn&& fn )
+  {
+    static_assert( Grain > 0, "parallel_for requires Grain > 0" );
+    if ( first >= last )
+      return;
+
+    struct sharedState
+    {
+      std::atomic<size_t> next;
+      std::atomic<size_t> pending;
+      size_t last;
+      std::remove_reference_t<Fn>* fn;
+
+      void run()
+      {
+        for ( ;; )
+        {
+          const auto begin = next.fetch_add( Grain, std::memory_order_relaxed );
+          if ( begin >= last )
+            return;
+          const auto end = std::min( begin + Grain, last );
+          for ( auto i = begin; i < end; ++i )
+            ( *fn )( i );
+        }
+      }
+    };
+
+    const auto chunks = ( last - first + Grain - 1 ) / Grain;
+    const auto helpers = std::min( WorkerCount, chunks - 1 );
+    sharedState state{ first, helpers, last, std::addressof( fn ) };
+    for ( size_t h = 0; h < helpers; ++h )
+    {
+      const auto submitted = try_submit( [ this, s = &state ]
+      {
+        s->run();
+        s->pending.fetch_sub( 1, std::memory_order_release ); // last touch of s
+        completions_.fetch_add( 1, std::memory_order_release );
+        completions_.notify_all();
+      } );
+      if ( !submitted )
+      {
+        state.pending.fetch_sub( helpers - h, std::memory_order_relaxed );
+        break;
+      }
+    }
+
+    try
+    {
+      state.run();
+    }
+    catch ( ... )
+    {
+      state.next.store( last, std::memory_order_relaxed );
+      waitForHelpers( state.pending );
+      throw;
+    }
+    waitForHelpers( state.pending );
+  }
+
+  // Observers ----------------------------------------------------------------
+
+  static constexpr size_type worker_count() noexcept
+  {
+    return WorkerCount;
+  }
+
+  static constexpr size_type queue_capacity() noexcept
+  {
+    return QueueCapacity;
+  }
+
+private:
+
+  static constexpr int kSpinCount = 64;
+
+  bool isWorker() const noexcept
+  {
+    return detail::tlsPoolWorker.pool == this;
+  }
+
+  bool anyQueued() const noexcept
+  {
+    for ( const auto& queue : queues_ )
+    {
+      if ( !queue.empty_approx() )
+        return true;
+    }
+    return false;
+  }
+
+  void wakeOne() noexcept
+  {
+    // Pairs with the fence in workerLoop: either the sleeper sees the new task or
+    // this thread sees the sleeper
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if ( sleepers_.load( std::memory_order_relaxed ) != 0 )
+    {
+      epoch_.fetch_add( 1, std::memory_order_release );
+      epoch_.notify_one();
+    }
+  }
+
+  void stopWorkers() noexcept
+  {
+    stop_.store( true, std::memory_order_seq_cst );
+    epoch_.fetch_add( 1, std::memory_order_release );
+    epoch_.notify_all();
+    for ( auto& thread : threads_ )
+    {
+      if ( thread.joinable() )
+        thread.join();
+    }
+  }
+
+  void waitForHelpers( const std::atomic<size_t>& pending )
+  {
+    for ( ;; )
+    {
+      const auto seen = completions_.load( std::memory_order_acquire );
+      if ( pending.load( std::memory_order_acquire ) == 0 )
+        return;
+      if ( !run_pending() )
+        completions_.wait( seen, std::memory_order_acquire );
+    }
+  }
+
+  void workerLoop( size_t index )
+  {
+    detail::tlsPoolWorker = { this, index };
+    for ( ;; )
+    {
+      bool ran = false;
+      for ( int spin = 0; spin < kSpinCount && !ran; ++spin )
+      {
+        ran = run_pending();
+        if ( !ran )
+          detail::cpuRelax();
+      }
+      if ( ran )
+        continue;
+
+      sleepers_.fetch_add( 1, std::memory_order_seq_cst );
+      std::atomic_thread_fence( std::memory_order_seq_cst );
+      const auto epoch = epoch_.load( std::memory_order_acquire );
+      const auto stopping = stop_.load( std::memory_order_acquire );
+      const auto queued = anyQueued();
+      if ( !stopping && !queued )
+        epoch_.wait( epoch, std::memory_order_acquire );
+      sleepers_.fetch_sub( 1, std::memory_order_relaxed );
+      if ( stopping && !queued )
+        return;
+    }
+  }
+
+private:
+
+  std::array<inplace_mpmc_queue<task_type, QueueCapacity>, WorkerCount> queues_;
+  alignas( detail::kCacheLineSize ) std::atomic<uint32_t> epoch_ = 0;    // bumped to wake sleepers
+  std::atomic<uint32_t> sleepers_ = 0;
+  std::atomic<bool> stop_ = false;
+  alignas( detail::kCacheLineSize ) std::atomic<size_t> nextQueue_ = 0;  // round-robin for outside submitters
+  alignas( detail::kCacheLineSize ) std::atomic<uint32_t> completions_ = 0; // parallel_for helpers finished
+  std::array<std::thread, WorkerCount> threads_;
+
+}; // class inplace_thread_pool
+
+} // namespace PKIsensee
+
+#pragma warning(pop)
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,215 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  inplace_top_k.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  Streaming bounded top-K accumulator
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <optional>
+#include <span>
+#include "inplace_algorithm.h"
+#include "inplace_vector.h"
+
+namespace PKIsensee
+{
+
+namespace detail
+{
+  template < typename T, typename Compare >
+  constexpr bool isSimdFilterable = ( std::is_same_v<T, float> || std::is_same_v<T, int32_t> ) &&
+    ( std::is_same_v<Compare, std::less<T>> || std::is_same_v<Compare, std::less<>> ||
+      std::is_same_v<Compare, std::greater<T>> || std::is_same_v<Compare, std::greater<>> );
+
+#if PKISENSEE_SSE2
+  // Returns a 4-bit mask of the values that comp( threshold, value ) accepts
+  template < typename Compare, typename T >
+  uint32_t acceptMask4( const T* values, T threshold ) noexcept
+  {
+    constexpr bool kKeepGreatest = std::is_same_v<Compare, std::less<T>> || std::is_same_v<Compare, std::less<>>;
+    if constexpr ( std::is_same_v<T, float> )
+    {
+      const auto v = _mm_loadu_ps( values );
+      const auto t = _mm_set1_ps( threshold );
+      return static_cast<uint32_t>( _mm_movemask_ps( kKeepGreatest ? _mm_cmpgt_ps( v, t ) : _mm_cmplt_ps( v, t ) ) );
+    }
+    else
+    {
+      const auto v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( values ) );
+      const auto t = _mm_set1_epi32( threshold );
+      const auto m = kKeepGreatest ? _mm_cmpgt_epi32( v, t ) : _mm_cmplt_epi32( v, t );
+      return static_cast<uint32_t>( _mm_movemask_ps( _mm_castsi128_ps( m ) ) );
+    }
+  }
+#endif
+
+}; // namespace detail
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Keeps the K greatest values under Compare from a stream of candidates; use
+// std::greater to keep the K least. Accepted candidates are appended to a buffer
+// of 2K. When it fills, nth_element keeps the best K and the K-th best becomes the
+// rejection threshold, so in steady state offer() is a single compare against the
+// threshold. offer_batch() filters four float or int32_t candidates per SSE2
+// compare. extract() sorts the survivors best first.
+//
+// Not thread-safe. Give each thread its own accumulator and merge() them
+// afterward; merging also adopts the tighter of the two thresholds. Performs no
+// memory allocations. Ties at the threshold are resolved arbitrarily.
+
+template < typename T, size_t K, typename Compare = std::less<T> >
+class inplace_top_k
+{
+  static_assert( K > 0, "inplace_top_k requires K > 0" );
+
+public:
+
+  using value_type  = T;
+  using size_type   = size_t;
+  using result_type = inplace_vector<T, K>;
+
+  static constexpr size_type kBufferCapacity = 2 * K;
+
+  // Constructors -------------------------------------------------------------
+
+  inplace_top_k() = default;
+
+  explicit inplace_top_k( const Compare& comp )
+    : comp_( comp )
+  {
+  }
+
+  // Candidates ---------------------------------------------------------------
+
+  // Returns false if value was rejected by the current threshold
+  bool offer( const T& value )
+  {
+    if ( threshold_ && !comp_( *threshold_, value ) )
+      return false;
+    buffer_.unchecked_push_back( value );
+    if ( buffer_.size() == kBufferCapacity )
+      shrink();
+    return true;
+  }
+
+  void offer_batch( std::span<const T> values )
+  {
+    const auto count = values.size();
+    size_t i = 0;
+#if PKISENSEE_SSE2
+    if constexpr ( detail::isSimdFilterable<T, Compare> )
+    {
+      // Reject four at a time; survivors go through offer(), which rechecks them
+      // against the threshold in case an earlier survivor tightened it
+      for ( ; i + 4 <= count; i += 4 )
+      {
+        if ( !threshold_ )
+        {
+          for ( size_t j = 0; j < 4; ++j )
+            offer( values[ i + j ] );
+          continue;
+        }
+        for ( auto mask = detail::acceptMask4<Compare>( values.data() + i, *threshold_ ); mask != 0; mask &= mask - 1 )
+          offer( values[ i + static_cast<size_t>( std::countr_zero( mask ) ) ] );
+      }
+    }
+#endif
+    for ( ; i < count; ++i )
+      offer( values[ i ] );
+  }
+
+  // Combines the candidates of other into this accumulator
+  void merge( const inplace_top_k& other )
+  {
+    offer_batch( detail::asSpan( other.buffer_ ) );
+    // Other holds K values no worse than its threshold, all now offered here, so
+    // the combined K-th best is no worse than it either. Adopting it first would
+    // reject other's values that tie the threshold.
+    if ( other.threshold_ && ( !threshold_ || comp_( *threshold_, *other.threshold_ ) ) )
+      threshold_ = other.threshold_;
+  }
+
+  // Returns the best min( K, candidates ) values, best first, and resets
+  result_type extract()
+  {
+    if ( buffer_.size() > K )
+      shrink();
+    PKIsensee::sort( buffer_, better() );
+    result_type result;
+    for ( auto& e : buffer_ )
+      result.unchecked_push_back( std::move( e ) );
+    clear();
+    return result;
+  }
+
+  void clear() noexcept
+  {
+    buffer_.clear();
+    threshold_.reset();
+  }
+
+  // Observers ----------------------------------------------------------------
+
+  // Number of values extract() would return
+  size_type size() const noexcept
+  {
+    return std::min( buffer_.size(), K );
+  }
+
+  bool empty() const noexcept
+  {
+    return buffer_.empty();
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return K;
+  }
+
+  // Candidates must compare better than this to be accepted; nullptr until the
+  // buffer first fills
+  const T* threshold() const noexcept
+  {
+    return threshold_ ? &*threshold_ : nullptr;
+  }
+
+private:
+
+  auto better() const
+  {
+    return [this]( const T& lhs, const T& rhs ) { return comp_( rhs, lhs ); };
+  }
+
+  void shrink()
+  {
+    // Keep the best K; the K-th best is the new threshold
+    PKIsensee::nth_element( buffer_, K - 1, better() );
+    buffer_.erase( buffer_.begin() + K, buffer_.end() );
+    threshold_ = buffer_[ K - 1 ];
+  }
+
+private:
+
+  inplace_vector<T, kBufferCapacity> buffer_;
+  std::optional<T> threshold_;
+  [[no_unique_address]] Compare comp_;
+
+}; // class inplace_top_k
+
+} // namespace PKIsensee
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,697 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  inplace_unordered_map.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  Fixed-capacity open-addressing hash containers with SIMD group probing
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <initializer_list>
+#include <tuple>
+#include <utility>
+#include "inplace_vector.h"
+
+#pragma warning(push)
+#pragma warning(disable: 26495) // "slots_ is uninitialized", by design
+
+namespace PKIsensee
+{
+
+namespace detail
+{
+  // Control byte values. Full slots hold the low 7 bits of the element's hash.
+  inline constexpr int8_t kCtrlEmpty   = -128;
+  inline constexpr int8_t kCtrlDeleted = -2;
+  inline constexpr size_t kGroupSize   = 16;
+
+  // Returns a mask with bit i set for each of the 16 control bytes at group equal to value
+  inline uint32_t matchByte( const int8_t* group, int8_t value ) noexcept
+  {
+#if PKISENSEE_SSE2
+    const auto ctrl = _mm_load_si128( reinterpret_cast<const __m128i*>( group ) );
+    return static_cast<uint32_t>( _mm_movemask_epi8( _mm_cmpeq_epi8( ctrl, _mm_set1_epi8( value ) ) ) );
+#else
+    uint32_t mask = 0;
+    for ( size_t i = 0; i < kGroupSize; ++i )
+      mask |= static_cast<uint32_t>( group[ i ] == value ) << i;
+    return mask;
+#endif
+  }
+
+  // Returns a mask with bit i set for each empty or deleted control byte (sign bit set)
+  inline uint32_t matchEmptyOrDeleted( const int8_t* group ) noexcept
+  {
+#if PKISENSEE_SSE2
+    const auto ctrl = _mm_load_si128( reinterpret_cast<const __m128i*>( group ) );
+    return static_cast<uint32_t>( _mm_movemask_epi8( ctrl ) );
+#else
+    uint32_t mask = 0;
+    for ( size_t i = 0; i < kGroupSize; ++i )
+      mask |= static_cast<uint32_t>( group[ i ] < 0 ) << i;
+    return mask;
+#endif
+  }
+
+  // Iterates full slots of a swissTable
+  template < typename Table, typename Slot >
+  class swissIterator
+  {
+  public:
+
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = std::remove_const_t<Slot>;
+    using difference_type   = ptrdiff_t;
+    using pointer           = Slot*;
+    using reference         = Slot&;
+
+    constexpr swissIterator() noexcept = default;
+
+    swissIterator( Table* table, size_t index ) noexcept
+      : table_( table ), index_( index )
+    {
+      skipEmpty();
+    }
+
+    template < typename OtherTable, typename OtherSlot >
+    swissIterator( const swissIterator<OtherTable, OtherSlot>& other ) noexcept
+      requires( std::is_convertible_v<OtherSlot*, Slot*> )
+      : table_( other.table() ), index_( other.index() )
+    {
+    }
+
+    reference operator*() const noexcept
+    {
+      return table_->slotAt( index_ );
+    }
+
+    pointer operator->() const noexcept
+    {
+      return std::addressof( **this );
+    }
+
+    swissIterator& operator++() noexcept
+    {
+      ++index_;
+      skipEmpty();
+      return *this;
+    }
+
+    swissIterator operator++( int ) noexcept
+    {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    friend bool operator==( const swissIterator& lhs, const swissIterator& rhs ) noexcept
+    {
+      return lhs.index_ == rhs.index_;
+    }
+
+    Table* table() const noexcept
+    {
+      return table_;
+    }
+
+    size_t index() const noexcept
+    {
+      return index_;
+    }
+
+  private:
+
+    void skipEmpty() noexcept
+    {
+      while ( index_ < Table::kSlotCount && !table_->isFull( index_ ) )
+        ++index_;
+    }
+
+  private:
+
+    Table* table_ = nullptr;
+    size_t index_ = 0;
+
+  }; // class swissIterator
+
+  ///////////////////////////////////////////////////////////////////////////////
+  //
+  // Open-addressing table in the Swiss-table style. Slots are split into aligned
+  // groups of 16; each slot has a control byte that is empty, deleted, or 7 bits
+  // of the element's hash. A probe compares all 16 control bytes of a group in one
+  // SSE2 instruction and only compares keys whose hash bits match. Groups are
+  // visited in triangular order, which covers every group.
+  //
+  // Element storage is uninitialized bytes, like inplace_vector's data_. There is
+  // at most Capacity elements, no allocation, and never a rehash. Erase leaves a
+  // tombstone unless the slot's group still has an empty slot; compact() rebuilds
+  // the table to reclaim tombstones.
+
+  template < typename Slot, typename Key, size_t Capacity, typename KeyOf,
+             typename Hash, typename KeyEqual, bool MutableSlots >
+  class swissTable
+  {
+  public:
+
+    static constexpr size_t kSlotCount  = std::max( kGroupSize, std::bit_ceil( Capacity + Capacity / 7 + 1 ) );
+    static constexpr size_t kGroupCount = kSlotCount / kGroupSize;
+
+    using key_type        = Key;
+    using value_type      = Slot;
+    using hasher          = Hash;
+    using key_equal       = KeyEqual;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+    using reference       = value_type&;
+    using const_reference = const value_type&;
+    using const_iterator  = swissIterator<const swissTable, const Slot>;
+    using iterator        = std::conditional_t<MutableSlots, swissIterator<swissTable, Slot>, const_iterator>;
+
+    // Constructors -----------------------------------------------------------
+
+    swissTable() noexcept
+    {
+      std::fill( std::begin( ctrl_ ), std::end( ctrl_ ), kCtrlEmpty );
+    }
+
+    explicit swissTable( const Hash& hash, const KeyEqual& equal = KeyEqual() )
+      : hash_( hash ), equal_( equal )
+    {
+      std::fill( std::begin( ctrl_ ), std::end( ctrl_ ), kCtrlEmpty );
+    }
+
+    swissTable( const swissTable& other )
+      : hash_( other.hash_ ), equal_( other.equal_ )
+    {
+      copyFrom( other );
+    }
+
+    swissTable( swissTable&& other ) noexcept( std::is_nothrow_move_constructible_v<Slot> )
+      : hash_( other.hash_ ), equal_( other.equal_ )
+    {
+      moveFrom( other );
+    }
+
+    ~swissTable()
+    {
+      destroyAll();
+    }
+
+    // Slot placement depends on the hasher, so the hasher travels with the elements
+    swissTable& operator=( const swissTable& rhs )
+    {
+      if ( this != &rhs )
+      {
+        clear();
+        hash_ = rhs.hash_;
+        equal_ = rhs.equal_;
+        copyFrom( rhs );
+      }
+      return *this;
+    }
+
+    swissTable& operator=( swissTable&& rhs ) noexcept( std::is_nothrow_move_constructible_v<Slot> )
+    {
+      if ( this != &rhs )
+      {
+        clear();
+        hash_ = rhs.hash_;
+        equal_ = rhs.equal_;
+        moveFrom( rhs );
+      }
+      return *this;
+    }
+
+    // Iterators --------------------------------------------------------------
+
+    iterator begin() noexcept
+    {
+      return iterator( this, 0 );
+    }
+
+    const_iterator begin() const noexcept
+    {
+      return const_iterator( this, 0 );
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+      return begin();
+    }
+
+    iterator end() noexcept
+    {
+      return iterator( this, kSlotCount );
+    }
+
+    const_iterator end() const noexcept
+    {
+      return const_iterator( this, kSlotCount );
+    }
+
+    const_iterator cend() const noexcept
+    {
+      return end();
+    }
+
+    // Size and capacity ------------------------------------------------------
+
+    bool empty() const noexcept
+    {
+      return size_ == 0;
+    }
+
+    size_type size() const noexcept
+    {
+      return size_;
+    }
+
+    static constexpr size_type max_size() noexcept
+    {
+      return Capacity;
+    }
+
+    static constexpr size_type capacity() noexcept
+    {
+      return Capacity;
+    }
+
+    size_type tombstone_count() const noexcept
+    {
+      return tombstones_;
+    }
+
+    // Modifiers --------------------------------------------------------------
+
+    // Inserts value if its key is absent. Returns {end(), false} if the table is full.
+    std::pair<iterator, bool> try_insert( const value_type& value )
+    {
+      return tryEmplaceImpl( KeyOf{}( value ), value );
+    }
+
+    std::pair<iterator, bool> try_insert( value_type&& value )
+    {
+      return tryEmplaceImpl( KeyOf{}( value ), std::move( value ) );
+    }
+
+    // Inserts value if its key is absent. Throws std::bad_alloc if the table is full.
+    std::pair<iterator, bool> insert( const value_type& value )
+    {
+      return throwIfFull( try_insert( value ) );
+    }
+
+    std::pair<iterator, bool> insert( value_type&& value )
+    {
+      return throwIfFull( try_insert( std::move( value ) ) );
+    }
+
+    template <typename... Types>
+    std::pair<iterator, bool> emplace( Types&&... values )
+    {
+      value_type value( std::forward<Types>( values )... );
+      return insert( std::move( value ) );
+    }
+
+    iterator erase( const_iterator pos )
+    {
+      assert( pos.index() < kSlotCount && isFull( pos.index() ) );
+      eraseAt( pos.index() );
+      return iterator( this, pos.index() + 1 );
+    }
+
+    size_type erase( const Key& key )
+    {
+      const auto i = findIndex( key, hashOf( key ) );
+      if ( i == kSlotCount )
+        return 0;
+      eraseAt( i );
+      return 1;
+    }
+
+    void clear() noexcept
+    {
+      destroyAll();
+      std::fill( std::begin( ctrl_ ), std::end( ctrl_ ), kCtrlEmpty );
+      size_ = 0;
+      tombstones_ = 0;
+    }
+
+    // Reinserts every element into fresh control bytes, reclaiming all tombstones
+    void compact()
+    {
+      if ( tombstones_ == 0 )
+        return;
+      swissTable rebuilt( hash_, equal_ );
+      for ( size_t i = 0; i < kSlotCount; ++i )
+      {
+        if ( isFull( i ) )
+        {
+          auto& slot = slotAt( i );
+          rebuilt.insertNew( rebuilt.hashOf( KeyOf{}( slot ) ), std::move( slot ) );
+        }
+      }
+      *this = std::move( rebuilt );
+    }
+
+    // Lookup -----------------------------------------------------------------
+
+    iterator find( const Key& key )
+    {
+      return iterator( this, findIndex( key, hashOf( key ) ) );
+    }
+
+    const_iterator find( const Key& key ) const
+    {
+      return const_iterator( this, findIndex( key, hashOf( key ) ) );
+    }
+
+    bool contains( const Key& key ) const
+    {
+      return findIndex( key, hashOf( key ) ) != kSlotCount;
+    }
+
+    size_type count( const Key& key ) const
+    {
+      return contains( key ) ? 1 : 0;
+    }
+
+    // Observers --------------------------------------------------------------
+
+    hasher hash_function() const
+    {
+      return hash_;
+    }
+
+    key_equal key_eq() const
+    {
+      return equal_;
+    }
+
+    // Used by iterators ------------------------------------------------------
+
+    bool isFull( size_t i ) const noexcept
+    {
+      return ctrl_[ i ] >= 0;
+    }
+
+    Slot& slotAt( size_t i ) noexcept
+    {
+      return reinterpret_cast<Slot*>( slots_ )[ i ];
+    }
+
+    const Slot& slotAt( size_t i ) const noexcept
+    {
+      return reinterpret_cast<const Slot*>( slots_ )[ i ];
+    }
+
+  protected:
+
+    size_t hashOf( const Key& key ) const
+    {
+      // Mix so that identity hashes of small integers spread across groups and
+      // control bytes
+      return toSizeHash( mixHash( static_cast<uint64_t>( hash_( key ) ) ) );
+    }
+
+    size_t findIndex( const Key& key, size_t hash ) const
+    {
+      // Returns kSlotCount if key is not present
+      const auto h2 = static_cast<int8_t>( hash & 0x7F );
+      auto group = ( hash >> 7 ) & ( kGroupCount - 1 );
+      for ( size_t probe = 1; probe <= kGroupCount; ++probe )
+      {
+        const auto ctrl = ctrl_ + group * kGroupSize;
+        for ( auto mask = matchByte( ctrl, h2 ); mask != 0; mask &= mask - 1 )
+        {
+          const auto i = group * kGroupSize + static_cast<size_t>( std::countr_zero( mask ) );
+          if ( equal_( KeyOf{}( slotAt( i ) ), key ) )
+            return i;
+        }
+        if ( matchByte( ctrl, kCtrlEmpty ) != 0 )
+          return kSlotCount; // probe sequence for key ends at the first group with an empty slot
+        group = ( group + probe ) & ( kGroupCount - 1 );
+      }
+      return kSlotCount;
+    }
+
+    template <typename... Types>
+    size_t insertNew( size_t hash, Types&&... values )
+    {
+      // Key must be absent and the table not full. Reuses the first empty or
+      // deleted slot along the key's probe sequence.
+      assert( size_ < Capacity );
+      auto group = ( hash >> 7 ) & ( kGroupCount - 1 );
+      for ( size_t probe = 1; ; ++probe )
+      {
+        const auto mask = matchEmptyOrDeleted( ctrl_ + group * kGroupSize );
+        if ( mask != 0 )
+        {
+          const auto i = group * kGroupSize + static_cast<size_t>( std::countr_zero( mask ) );
+          std::construct_at( std::addressof( slotAt( i ) ), std::forward<Types>( values )... );
+          if ( ctrl_[ i ] == kCtrlDeleted )
+            --tombstones_;
+          ctrl_[ i ] = static_cast<int8_t>( hash & 0x7F );
+          ++size_;
+          return i;
+        }
+        assert( probe < kGroupCount );
+        group = ( group + probe ) & ( kGroupCount - 1 );
+      }
+    }
+
+    template <typename K, typename... Types>
+    std::pair<iterator, bool> tryEmplaceImpl( const K& key, Types&&... values )
+    {
+      const auto hash = hashOf( key );
+      const auto found = findIndex( key, hash );
+      if ( found != kSlotCount )
+        return { iterator( this, found ), false };
+      if ( size_ == Capacity )
+        return { end(), false };
+      return { iterator( this, insertNew( hash, std::forward<Types>( values )... ) ), true };
+    }
+
+    std::pair<iterator, bool> throwIfFull( std::pair<iterator, bool> result )
+    {
+      if ( result.first == end() )
+        throw std::bad_alloc();
+      return result;
+    }
+
+    void eraseAt( size_t i ) noexcept
+    {
+      std::destroy_at( std::addressof( slotAt( i ) ) );
+      // A group with an empty slot ends every probe sequence that reaches it, so no
+      // sequence continues past this slot and it can become empty again
+      const auto groupStart = ( i / kGroupSize ) * kGroupSize;
+      if ( matchByte( ctrl_ + groupStart, kCtrlEmpty ) != 0 )
+        ctrl_[ i ] = kCtrlEmpty;
+      else
+      {
+        ctrl_[ i ] = kCtrlDeleted;
+        ++tombstones_;
+      }
+      --size_;
+    }
+
+  private:
+
+    void destroyAll() noexcept
+    {
+      if constexpr ( !std::is_trivially_destructible_v<Slot> )
+      {
+        for ( size_t i = 0; i < kSlotCount; ++i )
+        {
+          if ( isFull( i ) )
+            std::destroy_at( std::addressof( slotAt( i ) ) );
+        }
+      }
+    }
+
+    void copyFrom( const swissTable& other )
+    {
+      // Same slot count and hash, so every element keeps its slot
+      std::copy( std::begin( other.ctrl_ ), std::end( other.ctrl_ ), std::begin( ctrl_ ) );
+      size_ = 0;
+      tombstones_ = other.tombstones_;
+      for ( size_t i = 0; i < kSlotCount; ++i )
+      {
+        if ( other.isFull( i ) )
+        {
+          try
+          {
+            std::construct_at( std::addressof( slotAt( i ) ), other.slotAt( i ) );
+          }
+          catch ( ... )
+          {
+            // Mark unconstructed slots empty, then destroy the slots already built;
+            // a throwing copy constructor never reaches the destructor
+            std::fill( std::begin( ctrl_ ) + static_cast<ptrdiff_t>( i ), std::end( ctrl_ ), kCtrlEmpty );
+            clear();
+            throw;
+          }
+          ++size_;
+        }
+      }
+    }
+
+    void moveFrom( swissTable& other ) noexcept( std::is_nothrow_move_constructible_v<Slot> )
+    {
+      std::copy( std::begin( other.ctrl_ ), std::end( other.ctrl_ ), std::begin( ctrl_ ) );
+      for ( size_t i = 0; i < kSlotCount; ++i )
+      {
+        if ( other.isFull( i ) )
+          std::construct_at( std::addressof( slotAt( i ) ), std::move( other.slotAt( i ) ) );
+      }
+      size_ = other.size_;
+      tombstones_ = other.tombstones_;
+      other.clear(); // put moved-from object in valid but empty state
+    }
+
+  private:
+
+    alignas( Slot ) std::byte slots_[ sizeof( Slot ) * kSlotCount ];
+    alignas( kGroupSize ) int8_t ctrl_[ kSlotCount ];
+    size_t size_ = 0;
+    size_t tombstones_ = 0;
+    [[no_unique_address]] Hash hash_;
+    [[no_unique_address]] KeyEqual equal_;
+
+  }; // class swissTable
+
+  struct mapKeyOf
+  {
+    template < typename Pair >
+    const auto& operator()( const Pair& pair ) const noexcept
+    {
+      return pair.first;
+    }
+  };
+
+  struct setKeyOf
+  {
+    template < typename Key >
+    const Key& operator()( const Key& key ) const noexcept
+    {
+      return key;
+    }
+  };
+
+}; // namespace detail
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Hash map of at most Capacity elements with inline storage. See detail::swissTable.
+
+template < typename Key, typename Value, size_t Capacity, typename Hash = std::hash<Key>,
+           typename KeyEqual = std::equal_to<Key> >
+class inplace_unordered_map :
+  public detail::swissTable< std::pair<const Key, Value>, Key, Capacity, detail::mapKeyOf,
+                             Hash, KeyEqual, true >
+{
+  using base = detail::swissTable< std::pair<const Key, Value>, Key, Capacity, detail::mapKeyOf,
+                                   Hash, KeyEqual, true >;
+
+public:
+
+  using mapped_type = Value;
+  using typename base::iterator;
+
+  using base::base;
+
+  inplace_unordered_map() = default;
+
+  inplace_unordered_map( std::initializer_list<typename base::value_type> iList, const Hash& hash = Hash(),
+                         const KeyEqual& equal = KeyEqual() )
+    : base( hash, equal )
+  {
+    for ( const auto& e : iList )
+      this->insert( e );
+  }
+
+  // Inserts key with a value constructed from values if key is absent.
+  // Returns {end(), false} if the map is full.
+  template <typename... Types>
+  std::pair<iterator, bool> try_emplace_key( const Key& key, Types&&... values )
+  {
+    return this->tryEmplaceImpl( key, std::piecewise_construct, std::forward_as_tuple( key ),
+                                 std::forward_as_tuple( std::forward<Types>( values )... ) );
+  }
+
+  Value& operator[]( const Key& key )
+    requires( std::default_initializable<Value> )
+  {
+    return this->throwIfFull( try_emplace_key( key ) ).first->second;
+  }
+
+  Value& at( const Key& key )
+  {
+    const auto it = this->find( key );
+    if ( it == this->end() )
+      throw std::out_of_range( "inplace_unordered_map::at" );
+    return it->second;
+  }
+
+  const Value& at( const Key& key ) const
+  {
+    const auto it = this->find( key );
+    if ( it == this->end() )
+      throw std::out_of_range( "inplace_unordered_map::at" );
+    return it->second;
+  }
+
+  template <typename V>
+  std::pair<iterator, bool> insert_or_assign( const Key& key, V&& value )
+  {
+    auto result = this->throwIfFull( try_emplace_key( key, std::forward<V>( value ) ) );
+    if ( !result.second )
+      result.first->second = std::forward<V>( value );
+    return result;
+  }
+
+}; // class inplace_unordered_map
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Hash set of at most Capacity keys with inline storage. See detail::swissTable.
+
+template < typename Key, size_t Capacity, typename Hash = std::hash<Key>,
+           typename KeyEqual = std::equal_to<Key> >
+class inplace_unordered_set :
+  public detail::swissTable< Key, Key, Capacity, detail::setKeyOf, Hash, KeyEqual, false >
+{
+  using base = detail::swissTable< Key, Key, Capacity, detail::setKeyOf, Hash, KeyEqual, false >;
+
+public:
+
+  using base::base;
+
+  inplace_unordered_set() = default;
+
+  inplace_unordered_set( std::initializer_list<Key> iList, const Hash& hash = Hash(),
+                         const KeyEqual& equal = KeyEqual() )
+    : base( hash, equal )
+  {
+    for ( const auto& e : iList )
+      this->insert( e );
+  }
+
+}; // class inplace_unordered_set
+
+} // namespace PKIsensee
+
+#pragma warning(pop)
+
+///////////////////////////////////////////////////////////////////////////////
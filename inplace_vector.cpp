@@ -14,9 +14,30 @@
 // 
 ///////////////////////////////////////////////////////////////////////////////
 
+#include "concurrent_inplace_vector.h"
+#include "hashed_inplace_vector.h"
+#include "inplace_algorithm.h"
+#include "inplace_append_log.h"
+#include "inplace_channel.h"
+#include "inplace_eytzinger_set.h"
+#include "inplace_flat_map.h"
+#include "inplace_linear_map.h"
+#include "inplace_lru_cache.h"
+#include "inplace_mpmc_queue.h"
+#include "inplace_object_pool.h"
+#include "inplace_priority_queue.h"
+#include "inplace_slot_map.h"
+#include "inplace_sparse_set.h"
+#include "inplace_spsc_queue.h"
+#include "inplace_thread_pool.h"
+#include "inplace_top_k.h"
+#include "inplace_unordered_map.h"
 #include "inplace_vector.h"
+#include "inplace_ws_deque.h"
+#include "rcu_inplace_vector.h"
+#include "seqlock_inplace_vector.h"
 
-// Implementation file is useful for validating that the header will compile
+// Implementation file is useful for validating that the headers will compile
 // but is otherwise unnecessary
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -20,13 +20,30 @@
 
 #pragma once
 #include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cassert>
+#include <compare>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <iterator>
+#include <limits>
 #include <new>
 #include <ranges>
+#include <span>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined( _M_X64 ) || defined( __SSE2__ ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define PKISENSEE_SSE2 1
+#include <emmintrin.h>
+#else
+#define PKISENSEE_SSE2 0
+#endif
 
 #pragma warning(push)
 #pragma warning(disable: 26495) // "data_ is uninitialized", by design
@@ -50,6 +67,222 @@ namespace detail
     return static_cast<size_t>( d );
   }
 
+  // Synthesize a comparison operation even for objects that don't support <=> operator.
+  // Used in operator<=> below
+  struct synthThreeWay
+  {
+    template <typename U, typename V>
+    constexpr auto operator()( const U& lhs, const V& rhs ) const noexcept
+      requires requires
+    {
+      { lhs < rhs } -> std::convertible_to<bool>;
+      { lhs > rhs } -> std::convertible_to<bool>;
+    }
+    {
+      if constexpr ( std::three_way_comparable_with<U, V> )
+        return lhs <=> rhs; // U supports operator <=>
+      else
+      { // implement <=> equivalent using existing < and > operators
+        if ( lhs < rhs )
+          return std::strong_ordering::less;
+        if ( lhs > rhs )
+          return std::strong_ordering::greater;
+        return std::strong_ordering::equal;
+      }
+    }
+  };
+
+  // Scalars whose equality is equivalent to equality of their object representation.
+  // Class types are excluded even with unique object representations, because a
+  // user-defined operator== need not compare every byte.
+  template < typename T >
+  inline constexpr bool isBitwiseComparable = std::is_scalar_v<T> &&
+                                              std::has_unique_object_representations_v<T>;
+
+  // Types that order the same way memcmp() orders their bytes
+  template < typename T >
+  inline constexpr bool isBytewiseOrdered = isBitwiseComparable<T> && sizeof( T ) == 1 &&
+                                            ( std::is_unsigned_v<T> || std::is_same_v<T, std::byte> );
+
+  // Returns the offset of the first byte that differs, or count if all bytes match
+  inline size_t firstMismatchByte( const void* lhsBytes, const void* rhsBytes, size_t count ) noexcept
+  {
+    const auto lhs = static_cast<const unsigned char*>( lhsBytes );
+    const auto rhs = static_cast<const unsigned char*>( rhsBytes );
+    size_t i = 0;
+#if PKISENSEE_SSE2
+    for ( ; i + 16 <= count; i += 16 )
+    {
+      const auto l = _mm_loadu_si128( reinterpret_cast<const __m128i*>( lhs + i ) );
+      const auto r = _mm_loadu_si128( reinterpret_cast<const __m128i*>( rhs + i ) );
+      const auto equalMask = static_cast<unsigned>( _mm_movemask_epi8( _mm_cmpeq_epi8( l, r ) ) );
+      if ( equalMask != 0xFFFFu )
+        return i + static_cast<size_t>( std::countr_one( equalMask ) );
+    }
+#else
+    for ( ; i + sizeof( uint64_t ) <= count; i += sizeof( uint64_t ) )
+    {
+      uint64_t l, r;
+      std::memcpy( &l, lhs + i, sizeof( l ) );
+      std::memcpy( &r, rhs + i, sizeof( r ) );
+      if ( l != r )
+        break; // locate the byte below
+    }
+#endif
+    for ( ; i < count; ++i )
+    {
+      if ( lhs[ i ] != rhs[ i ] )
+        return i;
+    }
+    return count;
+  }
+
+  // Element-wise equality of [lhs, lhs + lhsSize) and [rhs, rhs + rhsSize).
+  // Bitwise comparable elements are compared as raw bytes.
+  template < typename T >
+  constexpr bool equalRange( const T* lhs, size_t lhsSize, const T* rhs, size_t rhsSize ) noexcept
+  {
+    if ( lhsSize != rhsSize )
+      return false;
+    if constexpr ( isBitwiseComparable<T> )
+    {
+      if ( !std::is_constant_evaluated() )
+        return lhsSize == 0 || std::memcmp( lhs, rhs, lhsSize * sizeof( T ) ) == 0;
+    }
+    return std::equal( lhs, lhs + lhsSize, rhs );
+  }
+
+  // Lexicographical three-way comparison of [lhs, lhs + lhsSize) and [rhs, rhs + rhsSize).
+  // Unsigned bytes are ordered by memcmp(); other bitwise comparable elements locate
+  // the first mismatching element with a vectorized byte search and compare only that pair.
+  template < typename T >
+  constexpr auto compareRange( const T* lhs, size_t lhsSize, const T* rhs, size_t rhsSize ) noexcept
+  {
+    if constexpr ( isBitwiseComparable<T> )
+    {
+      if ( !std::is_constant_evaluated() )
+      {
+        const auto count = std::min( lhsSize, rhsSize );
+        if constexpr ( isBytewiseOrdered<T> )
+        {
+          const auto result = ( count == 0 ) ? 0 : std::memcmp( lhs, rhs, count );
+          if ( result != 0 )
+            return result <=> 0;
+        }
+        else
+        {
+          const auto i = firstMismatchByte( lhs, rhs, count * sizeof( T ) ) / sizeof( T );
+          if ( i < count )
+            return synthThreeWay{}( lhs[ i ], rhs[ i ] );
+        }
+        return lhsSize <=> rhsSize;
+      }
+    }
+    return std::lexicographical_compare_three_way( lhs, lhs + lhsSize, rhs, rhs + rhsSize,
+                                                   synthThreeWay{} );
+  }
+
+  // Final avalanche step from MurmurHash3
+  constexpr uint64_t mixHash( uint64_t h ) noexcept
+  {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+  }
+
+  // Hashes count raw bytes. The main loop consumes 32 bytes per iteration in four
+  // independent 64-bit lanes, so there are no cross-lane dependencies and compilers
+  // are free to interleave or vectorize the multiplies.
+  inline uint64_t hashBytes( const void* bytes, size_t count ) noexcept
+  {
+    constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+    const auto p = static_cast<const unsigned char*>( bytes );
+    const auto load = [p]( size_t offset )
+    {
+      uint64_t word;
+      std::memcpy( &word, p + offset, sizeof( word ) );
+      return word;
+    };
+
+    uint64_t lanes[ 4 ] = { kPrime1, kPrime2, ~kPrime1, ~kPrime2 };
+    size_t i = 0;
+    for ( ; i + 32 <= count; i += 32 )
+    {
+      for ( size_t lane = 0; lane < 4; ++lane )
+        lanes[ lane ] = std::rotl( lanes[ lane ] ^ ( load( i + lane * 8 ) * kPrime2 ), 31 ) * kPrime1;
+    }
+    uint64_t h = std::rotl( lanes[ 0 ], 1 ) + std::rotl( lanes[ 1 ], 7 ) +
+                 std::rotl( lanes[ 2 ], 12 ) + std::rotl( lanes[ 3 ], 18 );
+    for ( ; i + 8 <= count; i += 8 )
+      h = std::rotl( h ^ ( load( i ) * kPrime2 ), 27 ) * kPrime1;
+    for ( ; i < count; ++i )
+      h = std::rotl( h ^ ( p[ i ] * kPrime1 ), 11 ) * kPrime2;
+    return mixHash( h ^ count );
+  }
+
+  // Folds a 64-bit hash into size_t on 32-bit platforms
+  constexpr size_t toSizeHash( uint64_t h ) noexcept
+  {
+    if constexpr ( sizeof( size_t ) < sizeof( uint64_t ) )
+      return static_cast<size_t>( h ^ ( h >> 32 ) );
+    else
+      return static_cast<size_t>( h );
+  }
+
+  // Alignment that keeps independently written atomics off each other's cache
+  // lines. Fixed rather than std::hardware_destructive_interference_size, which
+  // varies with compiler flags and so isn't ABI-stable.
+  inline constexpr size_t kCacheLineSize = 64;
+
+  // Spin-wait hint; lets a hyperthreaded sibling run and saves power
+  inline void cpuRelax() noexcept
+  {
+#if PKISENSEE_SSE2
+    _mm_pause();
+#endif
+  }
+
+  // Test-and-test-and-set lock for critical sections of a few instructions
+  class spinLock
+  {
+  public:
+
+    void lock() noexcept
+    {
+      while ( locked_.exchange( true, std::memory_order_acquire ) )
+      {
+        while ( locked_.load( std::memory_order_relaxed ) )
+          cpuRelax();
+      }
+    }
+
+    void unlock() noexcept
+    {
+      locked_.store( false, std::memory_order_release );
+    }
+
+  private:
+
+    std::atomic<bool> locked_ = false;
+
+  }; // class spinLock
+
+  // Stands in for a lock in single-threaded containers
+  struct nullLock
+  {
+    constexpr void lock() noexcept
+    {
+    }
+
+    constexpr void unlock() noexcept
+    {
+    }
+  };
+
 }; // namespace detail
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -111,6 +344,14 @@ public:
   constexpr inplace_vector( const inplace_vector& other ) // copy ctor
     requires( std::copyable<T> )
   {
+    if constexpr ( kIsTiny )
+    {
+      if ( !std::is_constant_evaluated() )
+      {
+        copyStorage( other );
+        return;
+      }
+    }
     for ( auto&& e : other )
       emplace_back( e );
   }
@@ -119,6 +360,15 @@ public:
     noexcept( Capacity == 0 || std::is_nothrow_move_constructible_v<T> )
     requires( std::movable<T> )
   {
+    if constexpr ( kIsTiny )
+    {
+      if ( !std::is_constant_evaluated() )
+      {
+        copyStorage( other );
+        other.size_ = 0;
+        return;
+      }
+    }
     for ( auto&& e : other )
       emplace_back( std::move( e ) );
     other.size_ = 0; // put moved-from object in valid but empty state
@@ -143,6 +393,15 @@ public:
   constexpr inplace_vector& operator=( const inplace_vector& rhs ) // copy assignment
     requires( std::copyable<T> )
   {
+    if constexpr ( kIsTiny )
+    {
+      if ( !std::is_constant_evaluated() )
+      {
+        if ( this != &rhs )
+          copyStorage( rhs );
+        return *this;
+      }
+    }
     clear();
     for ( auto&& e : rhs )
       emplace_back( e );
@@ -154,6 +413,18 @@ public:
                                  std::is_nothrow_move_constructible_v<T> ) )
     requires( std::movable<T> )
   {
+    if constexpr ( kIsTiny )
+    {
+      if ( !std::is_constant_evaluated() )
+      {
+        if ( this != &rhs )
+        {
+          copyStorage( rhs );
+          rhs.size_ = 0;
+        }
+        return *this;
+      }
+    }
     clear();
     for ( auto&& e : rhs )
       emplace_back( std::move( e ) );
@@ -388,7 +659,12 @@ public:
   constexpr iterator insert( const_iterator pos, const T& value )
     requires( std::constructible_from< T, const T& > && std::copyable<T> )
   {
-    return insert( pos, 1, value );
+    if constexpr ( kIsTiny )
+    {
+      if ( !std::is_constant_evaluated() )
+        return insertTiny( pos, value );
+    }
+    return emplace( pos, value );
   }
 
   constexpr iterator insert( const_iterator pos, T&& value )
@@ -425,7 +701,7 @@ public:
     // Add elements to the end and then rotate them into place
     auto newElementsPos = end();
     for ( ; first != last; ++first )
-      unchecked_emplace_back( ::std::move( *first ) );
+      unchecked_emplace_back( *first );
     return rotate( pos, newElementsPos, end() );
   }
 
@@ -450,11 +726,29 @@ public:
   {
     // Function inserts new elements before pos
     assert( pos >= begin() && pos <= end() );
+    if constexpr ( kIsTiny )
+    {
+      if ( !std::is_constant_evaluated() )
+        return insertTiny( pos, T( std::forward<Types>( values )... ) );
+    }
+
+    const auto i = static_cast<size_type>( pos - begin() );
+    if ( i == size() )
+    {
+      emplace_back( std::forward<Types>( values )... );
+      return begin() + i;
+    }
+    if ( size() == capacity() )
+      throw std::bad_alloc();
 
-    // Add element to the end and then rotate it into place
-    const auto newElementPos = end();
-    emplace_back( std::forward<Types>( values )... );
-    return rotate( pos, newElementPos, end() );
+    // Construct the element first in case values refer to elements of this vector.
+    // Shift the tail up one slot rather than rotating; move_backward compiles to
+    // memmove for trivially copyable T.
+    T value( std::forward<Types>( values )... );
+    unchecked_emplace_back( std::move( back() ) );
+    std::move_backward( begin() + i, end() - 2, end() - 1 );
+    ref( i ) = std::move( value );
+    return begin() + i;
   }
 
   template <typename... Types>
@@ -483,8 +777,11 @@ public:
   constexpr reference unchecked_emplace_back( Types&&... values )
     requires( std::constructible_from< T, Types... > )
   {
+    // Precondition size() < capacity() replaces the check in try_emplace_back()
     assert( size() < capacity() );
-    return *try_emplace_back( std::forward<Types>( values )... );
+    std::construct_at( end(), std::forward<Types>( values )... );
+    ++size_;
+    return back();
   }
 
   constexpr reference push_back( const T& value )
@@ -515,14 +812,12 @@ public:
 
   constexpr reference unchecked_push_back( const T& value )
   {
-    assert( size() < capacity() );
-    return *try_push_back( std::forward< decltype( value ) >( value ) );
+    return unchecked_emplace_back( std::forward< decltype( value ) >( value ) );
   }
 
   constexpr reference unchecked_push_back( T&& value )
   {
-    assert( size() < capacity() );
-    return *try_push_back( std::forward< decltype( value ) >( value ) );
+    return unchecked_emplace_back( std::forward< decltype( value ) >( value ) );
   }
 
   constexpr void pop_back()
@@ -584,6 +879,18 @@ public:
     if ( first == last )
       return first;
 
+    if constexpr ( kIsTiny )
+    {
+      if ( !std::is_constant_evaluated() )
+      {
+        // no destructors to run; shift the storage block down over the erased elements
+        shiftStorage( static_cast<size_type>( first - begin() ) * sizeof( T ),
+                      static_cast<size_type>( last - begin() ) * sizeof( T ) );
+        size_ -= static_cast<size_type>( last - first );
+        return first;
+      }
+    }
+
     // move [last, end()) to first
     const auto newLast = std::move( last, end(), first );
     destroy( newLast, end() );
@@ -604,6 +911,63 @@ public:
 
 private:
 
+  // Tiny vectors of trivial elements are copied, compared and shifted as whole
+  // fixed-size storage blocks, which compile to a few unconditional loads and stores
+  // with no loops over size().
+  static constexpr size_t kStorageBytes = sizeof( T ) * Capacity;
+  static constexpr bool kIsTiny = Capacity <= 8 && kStorageBytes <= 64 && std::is_trivial_v<T>;
+
+  constexpr void copyStorage( const inplace_vector& other ) noexcept
+  {
+    // Copies the entire block, including unused slots; std::byte storage makes
+    // copying the uninitialized bytes well-defined
+    static_assert( kIsTiny );
+    std::memcpy( data_, other.data_, kStorageBytes );
+    size_ = other.size_;
+  }
+
+  constexpr void shiftStorage( size_t dstOffset, size_t srcOffset ) noexcept
+  {
+    // Moves storage bytes [srcOffset, kStorageBytes) to dstOffset. Padded scratch blocks
+    // keep every copy fixed-size; bytes shifted past the end of storage are discarded.
+    static_assert( kIsTiny );
+    assert( dstOffset <= kStorageBytes && srcOffset <= kStorageBytes );
+    std::byte src[ 2 * kStorageBytes ];
+    std::byte dst[ 2 * kStorageBytes ];
+    std::memcpy( src, data_, kStorageBytes );
+    std::memcpy( dst, data_, kStorageBytes );
+    std::memcpy( dst + dstOffset, src + srcOffset, kStorageBytes );
+    std::memcpy( data_, dst, kStorageBytes );
+  }
+
+  constexpr iterator insertTiny( const_iterator pos, const T value )
+  {
+    // value is a copy, so it remains valid even if it referred to an element of this vector
+    static_assert( kIsTiny );
+    assert( pos >= begin() && pos <= end() );
+    if ( size() == capacity() )
+      throw std::bad_alloc();
+    const auto i = static_cast<size_type>( pos - begin() );
+    shiftStorage( ( i + 1 ) * sizeof( T ), i * sizeof( T ) );
+    std::construct_at( ptr( i ), value );
+    ++size_;
+    return begin() + i;
+  }
+
+  static bool equalTiny( const inplace_vector& lhs, const inplace_vector& rhs ) noexcept
+  {
+    // One fixed-size memcmp per possible size; each inlines to a few loads and compares
+    static_assert( kIsTiny && detail::isBitwiseComparable<T> );
+    if ( lhs.size() != rhs.size() )
+      return false;
+    return [&]<size_t... N>( std::index_sequence<N...> )
+    {
+      bool isEqual = true;
+      ( ( lhs.size() == N && ( isEqual = std::memcmp( lhs.data_, rhs.data_, N * sizeof( T ) ) == 0 ) ), ... );
+      return isEqual;
+    }( std::make_index_sequence<Capacity + 1>{} );
+  }
+
   template < typename ValueFactory >
   constexpr void resizeImpl( size_type count, ValueFactory&& getValue )
   {
@@ -631,9 +995,9 @@ private:
   {
     assert( first <= last );
     assert( first >= begin() && last <= end() );
-    if constexpr ( !std::is_trivial_v<T> )
+    if constexpr ( !std::is_trivially_destructible_v<T> )
     {
-      // dtors only necessary for non-trivial objects
+      // dtors only necessary for non-trivially destructible objects
       std::for_each( first, last, []( const auto& elem )
         {
           std::destroy_at( std::addressof( elem ) );
@@ -641,31 +1005,6 @@ private:
     }
   }
 
-  // Synthesize a comparison operation even for objects that don't support <=> operator.
-  // Used in operator<=> below
-  struct synthThreeWay
-  {
-    template <typename U, typename V>
-    constexpr auto operator()( const U& lhs, const V& rhs ) const noexcept
-      requires requires
-    {
-      { lhs < rhs } -> std::convertible_to<bool>;
-      { lhs > rhs } -> std::convertible_to<bool>;
-    }
-    {
-      if constexpr ( std::three_way_comparable_with<U, V> )
-        return lhs <=> rhs; // U supports operator <=>
-      else
-      { // implement <=> equivalent using existing < and > operators
-        if ( lhs < rhs )
-          return std::strong_ordering::less;
-        if ( lhs > rhs )
-          return std::strong_ordering::greater;
-        return std::strong_ordering::equal;
-      }
-    }
-  };
-
   constexpr pointer ptr( size_t i = 0 ) noexcept
   {
     assert( i < Capacity );
@@ -702,16 +1041,17 @@ public:
 
   friend constexpr bool operator==( const inplace_vector& lhs, const inplace_vector& rhs ) noexcept
   {
-    if ( lhs.size() != rhs.size() )
-      return false;
-    return std::ranges::equal( lhs, rhs );
+    if constexpr ( kIsTiny && detail::isBitwiseComparable<T> )
+    {
+      if ( !std::is_constant_evaluated() )
+        return equalTiny( lhs, rhs );
+    }
+    return detail::equalRange( lhs.begin(), lhs.size(), rhs.begin(), rhs.size() );
   }
 
   friend constexpr auto operator<=>( const inplace_vector& lhs, const inplace_vector& rhs ) noexcept
   {
-    return std::lexicographical_compare_three_way( std::begin( lhs ), std::end( lhs ),
-                                                   std::begin( rhs ), std::end( rhs ),
-                                                   synthThreeWay{} );
+    return detail::compareRange( lhs.begin(), lhs.size(), rhs.begin(), rhs.size() );
   }
 
   friend constexpr void swap( inplace_vector& lhs, inplace_vector& rhs )
@@ -747,6 +1087,39 @@ private:
 
 // Non-member functions
 
+// Comparisons against vectors of a different capacity and against any contiguous
+// sequence of T, without converting either side
+
+template < typename T, size_t LhsCapacity, size_t RhsCapacity >
+  requires( LhsCapacity != RhsCapacity )
+constexpr bool operator==( const inplace_vector<T, LhsCapacity>& lhs, 
+                           const inplace_vector<T, RhsCapacity>& rhs ) noexcept
+{
+  return detail::equalRange( lhs.begin(), lhs.size(), rhs.begin(), rhs.size() );
+}
+
+template < typename T, size_t LhsCapacity, size_t RhsCapacity >
+  requires( LhsCapacity != RhsCapacity )
+constexpr auto operator<=>( const inplace_vector<T, LhsCapacity>& lhs, 
+                            const inplace_vector<T, RhsCapacity>& rhs ) noexcept
+{
+  return detail::compareRange( lhs.begin(), lhs.size(), rhs.begin(), rhs.size() );
+}
+
+template < typename T, size_t Capacity >
+constexpr bool operator==( const inplace_vector<T, Capacity>& lhs,
+                           std::type_identity_t<std::span<const T>> rhs ) noexcept
+{
+  return detail::equalRange( lhs.begin(), lhs.size(), rhs.data(), rhs.size() );
+}
+
+template < typename T, size_t Capacity >
+constexpr auto operator<=>( const inplace_vector<T, Capacity>& lhs,
+                            std::type_identity_t<std::span<const T>> rhs ) noexcept
+{
+  return detail::compareRange( lhs.begin(), lhs.size(), rhs.data(), rhs.size() );
+}
+
 template < typename T, size_t Capacity, class U = T >
 constexpr auto erase( inplace_vector<T, Capacity>& vec, const U& value ) -> 
   inplace_vector<T, Capacity>::size_type
@@ -771,6 +1144,31 @@ constexpr auto erase_if( inplace_vector<T, Capacity>& vec, Pred pred ) ->
 
 } // namespace PKIsensee
 
+// Hash support. Bitwise comparable elements hash the raw bytes of the vector in a
+// single pass; other elements combine std::hash<T> of each element.
+
+template < typename T, size_t Capacity >
+  requires( PKIsensee::detail::isBitwiseComparable<T> ||
+            std::is_default_constructible_v<std::hash<T>> )
+struct std::hash<PKIsensee::inplace_vector<T, Capacity>>
+{
+  size_t operator()( const PKIsensee::inplace_vector<T, Capacity>& vec ) const noexcept
+  {
+    if constexpr ( PKIsensee::detail::isBitwiseComparable<T> )
+    {
+      return PKIsensee::detail::toSizeHash(
+        PKIsensee::detail::hashBytes( vec.begin(), vec.size() * sizeof( T ) ) );
+    }
+    else
+    {
+      uint64_t h = vec.size();
+      for ( const auto& e : vec )
+        h = PKIsensee::detail::mixHash( h ^ ( std::hash<T>{}( e ) + 0x9E3779B97F4A7C15ull ) );
+      return PKIsensee::detail::toSizeHash( h );
+    }
+  }
+};
+
 #pragma warning(pop)
 
 ///////////////////////////////////////////////////////////////////////////////
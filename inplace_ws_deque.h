@@ -0,0 +1,177 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  inplace_ws_deque.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  Fixed-capacity Chase-Lev work-stealing deque
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <new>
+#include "inplace_vector.h"
+
+#pragma warning(push)
+#pragma warning(disable: 4324)  // "structure was padded due to alignment specifier", by design
+
+namespace PKIsensee
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Chase-Lev deque with a fixed ring of Capacity slots stored inline. One owner
+// thread pushes and pops at the bottom (LIFO). Any number of thieves steal from
+// the top (FIFO) with a CAS. Owner pushes are plain loads and stores: the owner
+// caches top and rereads it only when the ring looks full. A pop needs a full
+// fence, and takes a CAS only when it races thieves for the last element.
+//
+// Thieves may read a slot while the owner reuses it; the loser of the CAS then
+// discards what it read. Slots are therefore relaxed atomics, and T must be
+// trivially copyable: task pointers, indices, small handles. steal() returns false
+// both when the deque is empty and when it loses a race, so callers treat it as a
+// hint and move on to another victim.
+//
+// try_push() returns false when full; push() throws std::bad_alloc. The ring never
+// grows, so no memory is ever reclaimed under a thief.
+
+template < typename T, size_t Capacity >
+class inplace_ws_deque
+{
+  static_assert( Capacity > 0, "inplace_ws_deque requires Capacity > 0" );
+  static_assert( std::is_trivially_copyable_v<T>, "inplace_ws_deque requires trivially copyable T" );
+
+public:
+
+  using value_type = T;
+  using size_type  = size_t;
+
+  // Constructors -------------------------------------------------------------
+
+  inplace_ws_deque() = default;
+
+  inplace_ws_deque( const inplace_ws_deque& ) = delete;
+  inplace_ws_deque& operator=( const inplace_ws_deque& ) = delete;
+
+  // Owner --------------------------------------------------------------------
+
+  // Returns false if the deque is full
+  bool try_push( const T& value ) noexcept
+  {
+    const auto b = bottom_.load( std::memory_order_relaxed );
+    if ( b - cachedTop_ >= kCapacity )
+    {
+      cachedTop_ = top_.load( std::memory_order_acquire );
+      if ( b - cachedTop_ >= kCapacity )
+        return false;
+    }
+    slotAt( b ).store( value, std::memory_order_relaxed );
+    bottom_.store( b + 1, std::memory_order_release );
+    return true;
+  }
+
+  void push( const T& value )
+  {
+    if ( !try_push( value ) )
+      throw std::bad_alloc();
+  }
+
+  // Takes the most recently pushed element; returns false if the deque is empty
+  bool try_pop( T& value ) noexcept
+  {
+    const auto b = bottom_.load( std::memory_order_relaxed ) - 1;
+    bottom_.store( b, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_seq_cst ); // publish the claim before reading top
+    auto t = top_.load( std::memory_order_relaxed );
+    if ( t > b )
+    {
+      bottom_.store( b + 1, std::memory_order_relaxed );
+      return false;
+    }
+    const auto popped = slotAt( b ).load( std::memory_order_relaxed );
+    if ( t == b )
+    {
+      // Last element: race thieves for it
+      const auto won = top_.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst,
+                                                     std::memory_order_relaxed );
+      bottom_.store( b + 1, std::memory_order_relaxed );
+      if ( !won )
+        return false;
+    }
+    value = popped;
+    return true;
+  }
+
+  // Thieves ------------------------------------------------------------------
+
+  // Takes the oldest element. Returns false if the deque is empty or another thread
+  // took the element first.
+  bool steal( T& value ) noexcept
+  {
+    auto t = top_.load( std::memory_order_acquire );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    const auto b = bottom_.load( std::memory_order_acquire );
+    if ( t >= b )
+      return false;
+    const auto stolen = slotAt( t ).load( std::memory_order_relaxed );
+    if ( !top_.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+      return false;
+    value = stolen;
+    return true;
+  }
+
+  // Observers ----------------------------------------------------------------
+
+  size_type size_approx() const noexcept
+  {
+    const auto t = top_.load( std::memory_order_relaxed );
+    const auto b = bottom_.load( std::memory_order_relaxed );
+    return ( b > t ) ? static_cast<size_type>( b - t ) : 0;
+  }
+
+  bool empty_approx() const noexcept
+  {
+    return size_approx() == 0;
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Capacity;
+  }
+
+private:
+
+  static constexpr int64_t kCapacity = static_cast<int64_t>( Capacity );
+
+  std::atomic<T>& slotAt( int64_t i ) noexcept
+  {
+    return slots_[ static_cast<size_t>( i ) % Capacity ];
+  }
+
+private:
+
+  // Signed so a pop from an empty deque may briefly move bottom below top
+  alignas( detail::kCacheLineSize ) std::atomic<int64_t> top_ = 0;    // written by thieves
+  alignas( detail::kCacheLineSize ) std::atomic<int64_t> bottom_ = 0; // written by owner
+  int64_t cachedTop_ = 0;                                              // owner's copy of top_
+  std::array<std::atomic<T>, Capacity> slots_{};
+
+}; // class inplace_ws_deque
+
+} // namespace PKIsensee
+
+#pragma warning(pop)
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,228 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  rcu_inplace_vector.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  Multi-buffered read-copy-update publication of inplace_vector contents
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <array>
+#include <atomic>
+#include "inplace_vector.h"
+
+#pragma warning(push)
+#pragma warning(disable: 4324)  // "structure was padded due to alignment specifier", by design
+
+namespace PKIsensee
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Read-copy-update over Buffers inplace_vectors. Epoch e is published in buffer
+// e % Buffers. A reader pins the current epoch by counting itself into that
+// buffer's reader count, and then reads the buffer in place: no copy, no lock. The
+// read costs two atomic read-modify-writes, pin and unpin, whatever the table
+// size. The writer builds the next epoch in the next buffer and publishes it by
+// storing the new epoch. Before it overwrites a buffer, it waits, on an atomic
+// wait rather than a spin, for the readers still pinned there to leave.
+//
+// With the default two buffers, a write waits only for readers that pinned the
+// epoch before last. Buffers > 2 lets long reads overlap several writes.
+//
+// A reader that pins just as the epoch changes sees the change on its recheck and
+// retries, so it never holds a buffer the writer may be reusing. Writers must be
+// serialized by the caller. Readers and the writer never allocate.
+
+template < typename T, size_t Capacity, size_t Buffers = 2 >
+class rcu_inplace_vector
+{
+  static_assert( Buffers >= 2, "rcu_inplace_vector requires Buffers >= 2" );
+
+public:
+
+  using value_type     = T;
+  using size_type      = size_t;
+  using container_type = inplace_vector<T, Capacity>;
+
+  /////////////////////////////////////////////////////////////////////////////
+  //
+  // Keeps one published version readable until destroyed. Guards should be short
+  // lived: the writer can't reuse the buffer while a guard pins it.
+
+  class read_guard
+  {
+  public:
+
+    read_guard( read_guard&& rhs ) noexcept
+      : owner_( std::exchange( rhs.owner_, nullptr ) ),
+        buffer_( rhs.buffer_ ),
+        epoch_( rhs.epoch_ )
+    {
+    }
+
+    read_guard( const read_guard& ) = delete;
+    read_guard& operator=( const read_guard& ) = delete;
+    read_guard& operator=( read_guard&& ) = delete;
+
+    ~read_guard()
+    {
+      if ( owner_ != nullptr )
+        owner_->unpin( buffer_ );
+    }
+
+    const container_type& operator*() const noexcept
+    {
+      return owner_->buffers_[ buffer_ ];
+    }
+
+    const container_type* operator->() const noexcept
+    {
+      return &owner_->buffers_[ buffer_ ];
+    }
+
+    // Version being read
+    uint64_t epoch() const noexcept
+    {
+      return epoch_;
+    }
+
+  private:
+
+    friend class rcu_inplace_vector;
+
+    read_guard( const rcu_inplace_vector* owner, size_t buffer, uint64_t epoch ) noexcept
+      : owner_( owner ),
+        buffer_( buffer ),
+        epoch_( epoch )
+    {
+    }
+
+  private:
+
+    const rcu_inplace_vector* owner_;
+    size_t buffer_;
+    uint64_t epoch_;
+
+  }; // class read_guard
+
+  // Constructors -------------------------------------------------------------
+
+  rcu_inplace_vector() = default;
+
+  rcu_inplace_vector( const rcu_inplace_vector& ) = delete;
+  rcu_inplace_vector& operator=( const rcu_inplace_vector& ) = delete;
+
+  // Readers ------------------------------------------------------------------
+
+  // Pins the published version
+  read_guard read() const noexcept
+  {
+    for ( ;; )
+    {
+      const auto epoch = epoch_.load( std::memory_order_acquire );
+      const auto buffer = static_cast<size_t>( epoch % Buffers );
+      readers_[ buffer ].count.fetch_add( 1, std::memory_order_seq_cst );
+      if ( epoch_.load( std::memory_order_seq_cst ) == epoch )
+        return read_guard( this, buffer, epoch );
+      unpin( buffer ); // a newer version appeared; the writer may be reusing this buffer
+    }
+  }
+
+  // Calls fn( const inplace_vector<T, Capacity>& ) on the published version and
+  // returns its result by value, since the version may be overwritten once unpinned.
+  // Use the read() guard to hold a reference into it.
+  template < typename Fn >
+  auto read( Fn&& fn ) const
+  {
+    const auto guard = read();
+    return fn( *guard );
+  }
+
+  // Number of versions published so far
+  uint64_t epoch() const noexcept
+  {
+    return epoch_.load( std::memory_order_acquire );
+  }
+
+  // Writer -------------------------------------------------------------------
+
+  // Copies the published version into the next buffer, calls
+  // fn( inplace_vector<T, Capacity>& ) on the copy and publishes it. If fn throws,
+  // nothing is published.
+  template < typename Fn >
+  void update( Fn&& fn )
+  {
+    const auto epoch = epoch_.load( std::memory_order_relaxed );
+    auto& next = acquireBuffer( epoch + 1 );
+    next = buffers_[ epoch % Buffers ];
+    fn( next );
+    epoch_.store( epoch + 1, std::memory_order_seq_cst );
+  }
+
+  // Like update, but fn fills an empty buffer; for tables rebuilt from scratch
+  template < typename Fn >
+  void rebuild( Fn&& fn )
+  {
+    const auto epoch = epoch_.load( std::memory_order_relaxed );
+    auto& next = acquireBuffer( epoch + 1 );
+    next.clear();
+    fn( next );
+    epoch_.store( epoch + 1, std::memory_order_seq_cst );
+  }
+
+private:
+
+  void unpin( size_t buffer ) const noexcept
+  {
+    auto& count = readers_[ buffer ].count;
+    if ( count.fetch_sub( 1, std::memory_order_seq_cst ) == 1 &&
+         writerWaiting_.load( std::memory_order_seq_cst ) )
+      count.notify_all();
+  }
+
+  // Waits until no reader pins the buffer for epoch, then hands it to the writer.
+  // The seq_cst flag store and count load pair with the reader's seq_cst decrement
+  // and flag load, so the last reader out always sees a waiting writer.
+  container_type& acquireBuffer( uint64_t epoch )
+  {
+    const auto buffer = static_cast<size_t>( epoch % Buffers );
+    auto& count = readers_[ buffer ].count;
+    writerWaiting_.store( true, std::memory_order_seq_cst );
+    for ( auto n = count.load( std::memory_order_seq_cst ); n != 0; n = count.load( std::memory_order_seq_cst ) )
+      count.wait( n, std::memory_order_seq_cst );
+    writerWaiting_.store( false, std::memory_order_relaxed );
+    return buffers_[ buffer ];
+  }
+
+private:
+
+  struct alignas( detail::kCacheLineSize ) readerCount
+  {
+    std::atomic<uint32_t> count = 0;
+  };
+
+  alignas( detail::kCacheLineSize ) std::atomic<uint64_t> epoch_ = 0;
+  std::atomic<bool> writerWaiting_ = false;
+  mutable std::array<readerCount, Buffers> readers_;
+  std::array<container_type, Buffers> buffers_;
+
+}; // class rcu_inplace_vector
+
+} // namespace PKIsensee
+
+#pragma warning(pop)
+
+///////////////////////////////////////////////////////////////////////////////
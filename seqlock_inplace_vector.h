@@ -0,0 +1,329 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  seqlock_inplace_vector.h
+//
+//  Copyright  Pete Isensee (PKIsensee@msn.com).
+//  All rights reserved worldwide.
+//
+//  Permission to copy, modify, reproduce or redistribute this source code is
+//  granted provided the above copyright notice is retained in the resulting 
+//  source code.
+// 
+//  This software is provided "as is" and without any express or implied
+//  warranties.
+// 
+// -----------------------------------------------------------------------------
+//
+//  Seqlock-protected vector for read-mostly data
+// 
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <span>
+#include "inplace_vector.h"
+
+#pragma warning(push)
+#pragma warning(disable: 4324)  // "structure was padded due to alignment specifier", by design
+
+namespace PKIsensee
+{
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Vector of at most Capacity trivially copyable elements, shared by one writer
+// and any number of readers. Readers never write shared memory. A read copies what
+// it needs, then checks that the sequence number is even and unchanged. If not, a
+// write overlapped and the read is repeated. Readers therefore never bounce a
+// lock's cache line between cores, and a reader can't stall the writer.
+//
+// Elements are stored as relaxed atomic 64-bit words, so a read that overlaps a
+// write is a well-defined torn copy that gets discarded, not a data race. On
+// mainstream targets relaxed word loads and stores are ordinary moves.
+//
+// snapshot() copies the whole vector. read( fn ) calls fn( view ) and returns its
+// result. fn may run more than once and may see an inconsistent view on a run
+// whose result is discarded, so it must have no side effects.
+//
+// Writers must be serialized by the caller. Each write publishes in place and
+// bumps the sequence number twice. push_back() throws std::bad_alloc when full.
+
+template < typename T, size_t Capacity >
+class seqlock_inplace_vector
+{
+  static_assert( Capacity > 0, "seqlock_inplace_vector requires Capacity > 0" );
+  static_assert( std::is_trivially_copyable_v<T>, "seqlock_inplace_vector requires trivially copyable T" );
+
+  static constexpr size_t kWordsPerElement = ( sizeof( T ) + sizeof( uint64_t ) - 1 ) / sizeof( uint64_t );
+
+  using word_array = std::array<uint64_t, kWordsPerElement>;
+
+public:
+
+  using value_type = T;
+  using size_type  = size_t;
+
+  /////////////////////////////////////////////////////////////////////////////
+  //
+  // Read access handed to read() visitors. Elements are returned by value. A view
+  // is valid only inside the visitor.
+
+  class view
+  {
+  public:
+
+    size_type size() const noexcept
+    {
+      return size_;
+    }
+
+    bool empty() const noexcept
+    {
+      return size_ == 0;
+    }
+
+    T operator[]( size_type i ) const noexcept
+    {
+      assert( i < size_ );
+      return vec_.loadElement( i );
+    }
+
+  private:
+
+    friend class seqlock_inplace_vector;
+
+    view( const seqlock_inplace_vector& vec, size_type size ) noexcept
+      : vec_( vec ),
+        size_( size )
+    {
+    }
+
+  private:
+
+    const seqlock_inplace_vector& vec_;
+    size_type size_;
+
+  }; // class view
+
+  // Constructors -------------------------------------------------------------
+
+  seqlock_inplace_vector() = default;
+
+  seqlock_inplace_vector( const seqlock_inplace_vector& ) = delete;
+  seqlock_inplace_vector& operator=( const seqlock_inplace_vector& ) = delete;
+
+  // Readers ------------------------------------------------------------------
+
+  // Calls fn( const view& ) until it completes without overlapping a write, and
+  // returns the result of that call
+  template < typename Fn >
+  auto read( Fn&& fn ) const
+  {
+    for ( ;; )
+    {
+      const auto seq = beginRead();
+      const view v( *this, size_.load( std::memory_order_relaxed ) );
+      if constexpr ( std::is_void_v<std::invoke_result_t<Fn&, const view&>> )
+      {
+        fn( v );
+        if ( endRead( seq ) )
+          return;
+      }
+      else
+      {
+        auto result = fn( v );
+        if ( endRead( seq ) )
+          return result;
+      }
+    }
+  }
+
+  // Consistent copy of every element
+  inplace_vector<T, Capacity> snapshot() const
+  {
+    inplace_vector<T, Capacity> copy;
+    snapshot( copy );
+    return copy;
+  }
+
+  void snapshot( inplace_vector<T, Capacity>& copy ) const
+  {
+    // Copy raw words first and build elements only from a validated copy
+    std::array<uint64_t, kWordsPerElement * Capacity> words;
+    size_type n;
+    for ( ;; )
+    {
+      const auto seq = beginRead();
+      n = size_.load( std::memory_order_relaxed );
+      for ( size_t w = 0; w < n * kWordsPerElement; ++w )
+        words[ w ] = words_[ w ].load( std::memory_order_relaxed );
+      if ( endRead( seq ) )
+        break;
+    }
+
+    copy.clear();
+    for ( size_type i = 0; i < n; ++i )
+      copy.unchecked_push_back( toElement( words.data() + i * kWordsPerElement ) );
+  }
+
+  // Consistent copy of element i; returns false if i is out of range
+  bool load( size_type i, T& value ) const
+  {
+    return read( [ i, &value ]( const view& v )
+    {
+      if ( i >= v.size() )
+        return false;
+      value = v[ i ];
+      return true;
+    } );
+  }
+
+  size_type size() const noexcept
+  {
+    return size_.load( std::memory_order_relaxed );
+  }
+
+  bool empty() const noexcept
+  {
+    return size() == 0;
+  }
+
+  static constexpr size_type capacity() noexcept
+  {
+    return Capacity;
+  }
+
+  // Writer -------------------------------------------------------------------
+
+  void store( size_type i, const T& value ) noexcept
+  {
+    assert( i < size() );
+    beginWrite();
+    storeElement( i, value );
+    endWrite();
+  }
+
+  // Returns false if full
+  bool try_push_back( const T& value ) noexcept
+  {
+    const auto n = size();
+    if ( n == Capacity )
+      return false;
+    beginWrite();
+    storeElement( n, value );
+    size_.store( n + 1, std::memory_order_relaxed );
+    endWrite();
+    return true;
+  }
+
+  void push_back( const T& value )
+  {
+    if ( !try_push_back( value ) )
+      throw std::bad_alloc();
+  }
+
+  void pop_back() noexcept
+  {
+    assert( !empty() );
+    beginWrite();
+    size_.store( size() - 1, std::memory_order_relaxed );
+    endWrite();
+  }
+
+  // Replaces the contents; throws std::bad_alloc if values exceeds Capacity
+  void assign( std::span<const T> values )
+  {
+    if ( values.size() > Capacity )
+      throw std::bad_alloc();
+    beginWrite();
+    for ( size_type i = 0; i < values.size(); ++i )
+      storeElement( i, values[ i ] );
+    size_.store( values.size(), std::memory_order_relaxed );
+    endWrite();
+  }
+
+  void clear() noexcept
+  {
+    beginWrite();
+    size_.store( 0, std::memory_order_relaxed );
+    endWrite();
+  }
+
+  // Calls fn( inplace_vector<T, Capacity>& ) on a copy of the contents and
+  // publishes the result as a single write
+  template < typename Fn >
+  void update( Fn&& fn )
+  {
+    auto copy = snapshot(); // the writer never races itself, so this never retries
+    fn( copy );
+    assign( copy );
+  }
+
+private:
+
+  uint64_t beginRead() const noexcept
+  {
+    for ( ;; )
+    {
+      const auto seq = seq_.load( std::memory_order_acquire );
+      if ( ( seq & 1 ) == 0 )
+        return seq;
+      detail::cpuRelax();
+    }
+  }
+
+  bool endRead( uint64_t seq ) const noexcept
+  {
+    std::atomic_thread_fence( std::memory_order_acquire ); // keeps the data loads above the recheck
+    return seq_.load( std::memory_order_relaxed ) == seq;
+  }
+
+  void beginWrite() noexcept
+  {
+    seq_.store( seq_.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release ); // keeps the data stores below the odd count
+  }
+
+  void endWrite() noexcept
+  {
+    seq_.store( seq_.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+  }
+
+  T loadElement( size_type i ) const noexcept
+  {
+    word_array words;
+    for ( size_t w = 0; w < kWordsPerElement; ++w )
+      words[ w ] = words_[ i * kWordsPerElement + w ].load( std::memory_order_relaxed );
+    return toElement( words.data() );
+  }
+
+  static T toElement( const uint64_t* words ) noexcept
+  {
+    std::array<std::byte, sizeof( T )> bytes;
+    std::memcpy( bytes.data(), words, sizeof( T ) );
+    return std::bit_cast<T>( bytes );
+  }
+
+  void storeElement( size_type i, const T& value ) noexcept
+  {
+    word_array words{};
+    std::memcpy( words.data(), std::addressof( value ), sizeof( T ) );
+    for ( size_t w = 0; w < kWordsPerElement; ++w )
+      words_[ i * kWordsPerElement + w ].store( words[ w ], std::memory_order_relaxed );
+  }
+
+private:
+
+  alignas( detail::kCacheLineSize ) std::atomic<uint64_t> seq_ = 0; // odd while a write is in progress
+  std::atomic<size_t> size_ = 0;
+  alignas( detail::kCacheLineSize ) std::array<std::atomic<uint64_t>, kWordsPerElement * Capacity> words_{};
+
+}; // class seqlock_inplace_vector
+
+} // namespace PKIsensee
+
+#pragma warning(pop)
+
+///////////////////////////////////////////////////////////////////////////////